@@ -0,0 +1,41 @@
+#ifndef _DETECTOR_H_
+#define _DETECTOR_H_
+#include <stdint.h>
+
+// 自适应门限检测：输入逐块（或逐点）的信号幅度，持续估计噪声底和信号峰值，
+// 在二者之间取开、关两个门限做迟滞判决，新状态须连续保持 min_dwell 次才被接受，
+// 换房间、换距离都不必再调电位器或改固定门限
+#define DETECTOR_ON_FRAC 0.5f      // 开门限：噪声底到峰值的1/2处
+#define DETECTOR_OFF_FRAC 0.25f    // 关门限：1/4处
+#define DETECTOR_MIN_SNR 4.0f      // 开门限至少为噪声底的4倍（12dB），只有噪声时峰值衰减下来也不会触发
+#define DETECTOR_FLOOR_P 0.2f      // 噪声底跟踪第20百分位：按键占空比不到一半，该分位点落在间隔里
+#define DETECTOR_FLOOR_STEP 0.02f  // 噪声底每次调整的相对步长
+#define DETECTOR_PEAK_DECAY 64     // 峰值每次向噪声底回落差值的1/64，信号消失后约64次内门限恢复
+
+typedef struct {
+    float floor;        // 噪声底估计（百分位跟踪）
+    float peak;         // 峰值估计（快升慢降的包络跟随）
+    float min_on;       // 开门限的绝对下限
+    uint8_t level;      // 当前判决
+    uint8_t pending;    // 与当前判决相反的输入已连续出现的次数
+    uint8_t min_dwell;
+} Detector;
+
+void Detector_Init(Detector *d, float min_on, uint8_t min_dwell);
+uint8_t Detector_Update(Detector *d, float amplitude);  // 输入一次幅度，返回去抖后的判决
+
+// 时间域去抖，用于只有边沿没有幅度的数字通道：持续不足 min_us 的脉冲（按键中的短暂掉线或
+// 间隔里的噪声尖峰）连同其两个边沿一起丢弃，其余边沿保留原时间戳，延迟 min_us 后放出
+typedef struct {
+    uint32_t ts;        // 待确认边沿的时间戳
+    uint32_t min_us;
+    uint8_t level;      // 已确认的电平
+    uint8_t pending;    // 有待确认的边沿（电平与level相反）
+} EdgeDebounce;
+
+void EdgeDebounce_Init(EdgeDebounce *e, uint32_t min_us, uint8_t level);
+void EdgeDebounce_Edge(EdgeDebounce *e, uint32_t ts, uint8_t level);  // 输入一个原始边沿，之前须先以ts调用Poll
+// 到now为止待确认边沿已保持足够久时取出它，返回1
+uint8_t EdgeDebounce_Poll(EdgeDebounce *e, uint32_t now, uint32_t *ts, uint8_t *level);
+
+#endif
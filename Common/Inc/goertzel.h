@@ -0,0 +1,17 @@
+#ifndef _GOERTZEL_H_
+#define _GOERTZEL_H_
+#include <stdint.h>
+
+// 单频点DFT（Goertzel算法），对一块采样求某一频率的能量
+// 目标频率取整到最近的DFT频点，这样直流偏置和频点外的整周期分量对结果没有贡献
+typedef struct {
+    float coeff;      // 2cos(2πk/N)
+    float freq_hz;    // 取整后的实际检测频率
+    uint16_t n;       // 块长
+} Goertzel;
+
+void Goertzel_Init(Goertzel *g, float freq_hz, float rate_hz, uint16_t n);
+// 对n个12位ADC采样计算该频点的幅度平方（单位为ADC计数的平方，满幅正弦约为 2048^2）
+float Goertzel_Power(const Goertzel *g, const uint16_t *x);
+
+#endif
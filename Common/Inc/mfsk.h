@@ -0,0 +1,47 @@
+#ifndef _MFSK_H_
+#define _MFSK_H_
+#include <stdint.h>
+#include "morse_timeline.h"
+
+// 1: 两板之间改用多音频移键控（MFSK）传输文本，每个符号4比特；0: 经典摩尔斯（默认）
+#define LINK_USE_MFSK 0
+
+// 每个符号发送 MFSK_TONES 个频率之一，频率取在接收端的DFT频点上（16kHz采样、128点一块，间隔125Hz），
+// 块内正好是整周期，其他频点上没有泄漏。最低音的3次谐波高于最高音，方波驱动也不会串音
+#define MFSK_TONES 17
+#define MFSK_BIN_HZ 125
+#define MFSK_BIN_FIRST 9            // 9*125 = 1125Hz 到 25*125 = 3125Hz
+#define MFSK_TONE_HZ(tone) ((MFSK_BIN_FIRST + (tone)) * MFSK_BIN_HZ)
+
+// 符号时长为接收块长（8ms）的3倍，不论相位如何每个符号都至少覆盖2个完整块；
+// 4比特/24ms 约每秒20个字符，是24 WPM摩尔斯的10倍
+#define MFSK_SYMBOL_US 24000U
+#define MFSK_CONFIRM_BLOCKS 2       // 同一频率连续出现的块数达到此值才确认为一个符号
+
+// 差分编码：每个符号的频率 = (上一个频率 + 1 + 4比特值) mod 17，相邻符号的频率必然不同，
+// 接收端按频率变化切分符号，不需要与发送端同步时钟。每次从静音开始先发频率0作为参考，
+// 之后每个字节拆成两个符号（高4位先发）
+typedef struct {
+    uint8_t tone;     // 上一个符号的频率序号
+    uint8_t byte;     // 当前字节
+    uint8_t left;     // 当前字节尚未发送的4比特个数
+    uint8_t started;  // 已发送参考符号
+} MfskEncoder;
+
+typedef struct {
+    int8_t tone;      // 最近连续出现的频率序号，-1为静音
+    uint8_t count;    // 该频率已连续的块数
+    int8_t last;      // 上一个已确认符号的频率，-1表示等待参考符号
+    uint8_t byte;     // 已收到的高4位
+    uint8_t half;     // 1: 已收到高4位
+} MfskDecoder;
+
+void Mfsk_EncoderInit(MfskEncoder *e);
+// 下一个符号的频率序号，字符源已空返回-1；之后再有字符时重新从参考符号开始
+int8_t Mfsk_Next(MfskEncoder *e, MorseCharSource src, void *ctx);
+
+void Mfsk_DecoderInit(MfskDecoder *d);
+// 每块调用一次，tone为该块能量最大的频率序号（低于门限为-1）；收齐一个字节时返回该字符，否则返回 '\0'
+char Mfsk_Block(MfskDecoder *d, int8_t tone);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef _MORSE_H_
+#define _MORSE_H_
+#include <stdint.h>
+
+// 打包格式：高3位为点划个数，低5位为点划序列（先发送的在高位，1为划，0为点）
+// 例如 'A' = .- = (2 << 5) | 0b01 = 0x41
+#define MORSE_LEN(code)  ((uint8_t)(code) >> 5)
+#define MORSE_BITS(code) ((uint8_t)(code) & 0x1F)
+#define MORSE_PACK(len, bits) ((uint8_t)(((len) << 5) | (bits)))
+
+// 发送端蜂鸣器音调频率（Hz），接收端按此频率检测音调能量
+#define MORSE_TONE_HZ 2000
+
+// A-Z 之后为 0-9
+extern const uint8_t MORSE_CODE_TABLE[36];
+
+// 二分树解码：根节点为1，收到点走到 2i，收到划走到 2i+1，
+// 节点号恰好等于 (1 << 点划个数) | 点划序列，0 表示已走出码表
+#define MORSE_TREE_ROOT 1
+#define MORSE_TREE_SIZE 64
+extern const char MORSE_TREE[MORSE_TREE_SIZE];
+
+// 叶子节点位图：该节点是完整字符，且再加任何点划都不会得到码表中的字符
+// （F L P X C Y Q 及全部数字），收到后即可确定，不必等字母间隔
+#define MORSE_TREE_LEAVES 0xD101808B2E540000ULL
+
+uint8_t Morse_Encode(char c);  // 字母（不区分大小写）或数字转打包码，不支持的字符返回0
+
+// 每收到一个点（dash=0）或划（dash=1）前进一步，超过5个点划后返回0并保持为0
+static inline uint8_t Morse_TreeStep(uint8_t node, uint8_t dash) {
+    uint8_t next = (uint8_t)((node << 1) | dash);
+    return (uint8_t)(next & -(uint8_t)((uint8_t)(node - 1) < MORSE_TREE_SIZE / 2 - 1));
+}
+
+// 当前节点对应的字符，不是完整字符时返回 '\0'
+static inline char Morse_TreeChar(uint8_t node) {
+    return MORSE_TREE[node & (MORSE_TREE_SIZE - 1)];
+}
+
+static inline uint8_t Morse_TreeIsLeaf(uint8_t node) {
+    return (uint8_t)((MORSE_TREE_LEAVES >> (node & (MORSE_TREE_SIZE - 1))) & 1U);
+}
+
+#endif
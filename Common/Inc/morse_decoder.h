@@ -0,0 +1,45 @@
+#ifndef _MORSE_DECODER_H_
+#define _MORSE_DECODER_H_
+#include <stdint.h>
+#include "morse.h"
+#include "morse_timing.h"
+
+// 点长估计的范围（微秒），约对应 80 WPM 到 3 WPM
+#define MORSE_DOT_MIN_US 15000U
+#define MORSE_DOT_MAX_US 400000U
+
+// 逐个点划解码，并在线估计发送速度：
+// 点、划各自做指数滑动平均（权重1/4），一类更新时按1:3把另一类也往回拉一点，
+// 这样只收到点或只收到划时另一类的估计也能跟上速度变化
+typedef struct {
+    uint32_t dot_us;   // 点长估计
+    uint32_t dash_us;  // 划长估计
+    uint32_t char_gap_x16;  // 字母间隔判决门限（单位数 x16），由约定的时序得到
+    uint32_t word_gap_x16;  // 单词间隔判决门限（单位数 x16）
+    uint8_t node;      // 当前字符在解码树中的位置
+    uint8_t in_word;   // 已输出字母、尚未输出单词间隔
+    uint8_t early;     // 提前输出：当前点划已唯一确定字符时立即输出，不等字母间隔
+    uint8_t committed; // 当前字符已提前输出
+    uint8_t retract;   // 提前输出后又收到了同一字符的点划，需输出 '\b' 撤回
+} MorseDecoder;
+
+// 以约定时序的点长作为初始估计，间隔门限取约定的相邻两种间隔的中点，之后随点长估计等比例缩放
+void MorseDecoder_Init(MorseDecoder *d, const MorseTiming *t, uint8_t early);
+uint32_t MorseDecoder_Unit(const MorseDecoder *d);          // 当前的单位时长（微秒）
+uint8_t MorseDecoder_Mark(MorseDecoder *d, uint32_t us);    // 一次按键结束：0噪声，1点，2划
+void MorseDecoder_Space(MorseDecoder *d, uint32_t us);      // 一次间隔结束，用点划之间的间隔修正估计
+// 间隔已持续gap_us时应输出的字符：字母、' '（单词间隔）、'\b'（撤回提前输出的字母）或 '\0'（暂无），
+// 可反复调用直到返回 '\0'；提前输出模式下每次按键结束后也应以gap_us=0调用
+char MorseDecoder_Poll(MorseDecoder *d, uint32_t gap_us);
+void MorseDecoder_Abort(MorseDecoder *d);                   // 丢弃正在接收的字符（例如丢失了边沿），保留速度估计
+
+// 由单位时长得到的间隔判决门限（标准时序下分别为2个和5个单位）
+static inline uint32_t MorseDecoder_CharGapUs(const MorseDecoder *d) {
+    return MorseDecoder_Unit(d) * d->char_gap_x16 / 16;
+}
+
+static inline uint32_t MorseDecoder_WordGapUs(const MorseDecoder *d) {
+    return MorseDecoder_Unit(d) * d->word_gap_x16 / 16;
+}
+
+#endif
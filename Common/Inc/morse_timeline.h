@@ -0,0 +1,27 @@
+#ifndef _MORSE_TIMELINE_H_
+#define _MORSE_TIMELINE_H_
+#include <stdint.h>
+#include "morse_timing.h"
+
+// 把文本展开成按键/间隔交替的游程（单位微秒）：
+// 点1个单位、划3个单位，点划之间隔1个单位，字母和单词间隔见 MorseTiming
+
+typedef char (*MorseCharSource)(void *ctx);  // 返回下一个待发送字符，已无字符时返回 '\0'
+
+typedef struct {
+    MorseTiming timing;
+    uint8_t bits;     // 当前字符尚未发送的点划（高位先发）
+    uint8_t left;     // 当前字符剩余的点划个数
+    uint8_t mark;     // 上一段是按键
+} MorseRunGen;
+
+void MorseRun_Init(MorseRunGen *g, const MorseTiming *t);
+// 生成下一段及其时长：返回1为按键，0为间隔，-1表示字符源已空（之后可继续调用）
+// 不支持的字符直接跳过，空格和换行为单词间隔
+int8_t MorseRun_Next(MorseRunGen *g, MorseCharSource src, void *ctx, uint32_t *us);
+
+// 整条消息展开成游程数组：下标为偶数的是按键、奇数的是间隔，相邻同电平已合并，
+// 去掉开头的间隔，结尾保留最后一个字母间隔；返回游程个数，超过max时截断
+uint16_t Morse_Timeline(const char *text, const MorseTiming *t, uint32_t *runs, uint16_t max);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _MORSE_TIMING_H_
+#define _MORSE_TIMING_H_
+#include <stdint.h>
+
+// 收发双方约定的速度：整体速度与字符速度（WPM，按PARIS标准，一个单词50个单位）
+// 字符速度高于整体速度时为Farnsworth方式：点划按字符速度发送，只拉长字母和单词间隔
+#define MORSE_WPM 24
+#define MORSE_CHAR_WPM 24
+
+typedef struct {
+    uint32_t dot_us;         // 单位时长（按字符速度）：点、点划之间的间隔
+    uint32_t letter_gap_us;  // 字母间隔
+    uint32_t word_gap_us;    // 单词间隔
+} MorseTiming;
+
+// char_wpm 不高于 wpm 时按标准时序（间隔为3、7个单位）
+void MorseTiming_Init(MorseTiming *t, uint8_t wpm, uint8_t char_wpm);
+
+#endif
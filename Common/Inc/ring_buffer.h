@@ -0,0 +1,65 @@
+#ifndef _RING_BUFFER_H_
+#define _RING_BUFFER_H_
+#include <stdint.h>
+
+// 单生产者/单消费者的无锁环形缓冲：一端在中断（或DMA回调）里、另一端在主循环里时不必关中断。
+// 这里只管读写位置，数据数组由使用者按任意元素类型定义，长度必须是2的幂且不超过32768。
+// head、tail为自由增长的计数，取下标时按长度掩码，缓冲可以全部用满；
+// head只由生产者写，tail只由消费者写。写对方要读的位置用release存储，读对方的位置用acquire加载，
+// 在Cortex-M4上编译为DMB：生产者写入的数据一定先于新的head可见，消费者读完数据才让出位置
+typedef struct {
+    volatile uint16_t head;  // 生产者已放入的总数
+    volatile uint16_t tail;  // 消费者已取走的总数
+    uint16_t mask;           // 长度-1
+} Ring;
+
+// 长度不是2的幂或超过32768时返回0，此时按长度1设置，下标恒为0，不会越界
+static inline uint8_t Ring_Init(Ring *r, uint16_t size) {
+    uint8_t ok = size != 0 && (size & (size - 1U)) == 0 && size <= 32768U;
+
+    r->head = 0;
+    r->tail = 0;
+    r->mask = ok ? (uint16_t)(size - 1U) : 0;
+    return ok;
+}
+
+// 当前可读的元素数，两端都可调用
+static inline uint16_t Ring_Count(const Ring *r) {
+    return (uint16_t)(__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+}
+
+// ---- 生产者 ----
+// 还能放入的元素数
+static inline uint16_t Ring_Free(const Ring *r) {
+    return (uint16_t)(r->mask + 1U - Ring_Count(r));
+}
+
+// 下一个写入位置的下标
+static inline uint16_t Ring_Head(const Ring *r) {
+    return r->head & r->mask;
+}
+
+// 数据写好后放出n个元素
+static inline void Ring_Publish(Ring *r, uint16_t n) {
+    __atomic_store_n(&r->head, (uint16_t)(r->head + n), __ATOMIC_RELEASE);
+}
+
+// ---- 消费者 ----
+// 下一个读取位置的下标
+static inline uint16_t Ring_Tail(const Ring *r) {
+    return r->tail & r->mask;
+}
+
+// 从读取位置起不回绕的可读元素数，用于把一整段交给DMA或按块处理
+static inline uint16_t Ring_Contiguous(const Ring *r) {
+    uint16_t count = Ring_Count(r);
+    uint16_t to_end = (uint16_t)(r->mask + 1U - Ring_Tail(r));
+    return count < to_end ? count : to_end;
+}
+
+// 用完数据后让出n个元素的位置
+static inline void Ring_Consume(Ring *r, uint16_t n) {
+    __atomic_store_n(&r->tail, (uint16_t)(r->tail + n), __ATOMIC_RELEASE);
+}
+
+#endif
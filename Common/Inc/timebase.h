@@ -0,0 +1,24 @@
+#ifndef _TIMEBASE_H_
+#define _TIMEBASE_H_
+#include <stdint.h>
+
+// 32位自由运行的微秒时钟，约71分钟回绕一次，取代1kHz的 HAL_GetTick（分辨率1ms、每次最多1ms抖动）。
+// 由各工程的 timebase.c 读取一个1MHz计数的32位定时器：MCU1为TIM2，MCU2为与PA0捕获共用的TIM2
+uint32_t Timebase_Now(void);
+
+// 自since起经过的微秒数，计数器回绕后仍正确
+static inline uint32_t Timebase_Elapsed(uint32_t since) {
+    return Timebase_Now() - since;
+}
+
+// 从现在起delay_us后的截止时刻
+static inline uint32_t Timebase_After(uint32_t delay_us) {
+    return Timebase_Now() + delay_us;
+}
+
+// 截止时刻是否已到，截止时刻须在前后约35分钟以内
+static inline uint8_t Timebase_Reached(uint32_t deadline) {
+    return (int32_t)(Timebase_Now() - deadline) >= 0;
+}
+
+#endif
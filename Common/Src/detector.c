@@ -0,0 +1,79 @@
+#include "detector.h"
+
+void Detector_Init(Detector *d, float min_on, uint8_t min_dwell) {
+    d->floor = min_on / DETECTOR_MIN_SNR;
+    d->peak = d->floor;
+    d->min_on = min_on;
+    d->level = 0;
+    d->pending = 0;
+    d->min_dwell = min_dwell;
+}
+
+uint8_t Detector_Update(Detector *d, float x) {
+    // 百分位跟踪：高于估计时按p、低于时按1-p的比例调整，平衡点处恰有p的输入低于估计
+    if (x > d->floor) {
+        d->floor *= 1.0f + DETECTOR_FLOOR_STEP * DETECTOR_FLOOR_P;
+    } else {
+        d->floor *= 1.0f - DETECTOR_FLOOR_STEP * (1.0f - DETECTOR_FLOOR_P);
+    }
+    if (d->floor < 1.0f) {
+        d->floor = 1.0f;
+    }
+
+    // 包络跟随：立即跟上新的峰值，之后慢慢回落到噪声底
+    if (x > d->peak) {
+        d->peak = x;
+    } else {
+        d->peak -= (d->peak - d->floor) / DETECTOR_PEAK_DECAY;
+    }
+
+    // 门限按有效峰值计算，有效峰值至少为噪声底的2*MIN_SNR倍，开门限因此不低于约MIN_SNR倍噪声底
+    float peak = d->peak;
+    if (peak < d->floor * 2.0f * DETECTOR_MIN_SNR) {
+        peak = d->floor * 2.0f * DETECTOR_MIN_SNR;
+    }
+    float on = d->floor + (peak - d->floor) * DETECTOR_ON_FRAC;
+    float off = d->floor + (peak - d->floor) * DETECTOR_OFF_FRAC;
+    if (on < d->min_on) {
+        on = d->min_on;
+    }
+
+    uint8_t raw = d->level ? (x > off) : (x >= on);
+    if (raw == d->level) {
+        d->pending = 0;
+    } else if (++d->pending >= d->min_dwell) {
+        d->level = raw;
+        d->pending = 0;
+    }
+    return d->level;
+}
+
+void EdgeDebounce_Init(EdgeDebounce *e, uint32_t min_us, uint8_t level) {
+    e->ts = 0;
+    e->min_us = min_us;
+    e->level = level;
+    e->pending = 0;
+}
+
+void EdgeDebounce_Edge(EdgeDebounce *e, uint32_t ts, uint8_t level) {
+    if (e->pending) {
+        // 待确认的边沿还没保持够就翻回来了：整个短脉冲丢弃
+        if (level == e->level) {
+            e->pending = 0;
+        }
+    } else if (level != e->level) {
+        e->ts = ts;
+        e->pending = 1;
+    }
+}
+
+uint8_t EdgeDebounce_Poll(EdgeDebounce *e, uint32_t now, uint32_t *ts, uint8_t *level) {
+    if (!e->pending || now - e->ts < e->min_us) {
+        return 0;
+    }
+    e->level ^= 1;
+    e->pending = 0;
+    *ts = e->ts;
+    *level = e->level;
+    return 1;
+}
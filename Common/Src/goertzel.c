@@ -0,0 +1,26 @@
+#include "goertzel.h"
+#include <math.h>
+
+#define GOERTZEL_PI 3.14159265f
+#define GOERTZEL_ADC_MID 2048.0f  // 12位ADC中点，先减去以减小浮点累加误差
+
+void Goertzel_Init(Goertzel *g, float freq_hz, float rate_hz, uint16_t n) {
+    uint16_t k = (uint16_t)(freq_hz * n / rate_hz + 0.5f);
+
+    g->n = n;
+    g->freq_hz = k * rate_hz / n;
+    g->coeff = 2.0f * cosf(2.0f * GOERTZEL_PI * k / n);
+}
+
+float Goertzel_Power(const Goertzel *g, const uint16_t *x) {
+    float s1 = 0.0f, s2 = 0.0f;
+
+    for (uint16_t i = 0; i < g->n; i++) {
+        float s0 = ((float)x[i] - GOERTZEL_ADC_MID) + g->coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    // |X(k)|^2 = s1^2 + s2^2 - coeff*s1*s2，再乘 (2/N)^2 换算成正弦幅度的平方
+    float power = s1 * s1 + s2 * s2 - g->coeff * s1 * s2;
+    return power * 4.0f / ((float)g->n * g->n);
+}
@@ -0,0 +1,73 @@
+#include "mfsk.h"
+
+void Mfsk_EncoderInit(MfskEncoder *e) {
+    e->tone = 0;
+    e->byte = 0;
+    e->left = 0;
+    e->started = 0;
+}
+
+int8_t Mfsk_Next(MfskEncoder *e, MorseCharSource src, void *ctx) {
+    if (e->left == 0) {
+        char c = src(ctx);
+        if (c == '\0') {
+            e->started = 0;
+            return -1;
+        }
+        e->byte = (uint8_t)c;
+        e->left = 2;
+        if (!e->started) {
+            e->started = 1;
+            e->tone = 0;
+            return 0;
+        }
+    }
+
+    e->left--;
+    uint8_t value = e->left != 0 ? (uint8_t)(e->byte >> 4) : (uint8_t)(e->byte & 0x0F);
+    e->tone = (uint8_t)((e->tone + 1 + value) % MFSK_TONES);
+    return (int8_t)e->tone;
+}
+
+void Mfsk_DecoderInit(MfskDecoder *d) {
+    d->tone = -1;
+    d->count = 0;
+    d->last = -1;
+    d->byte = 0;
+    d->half = 0;
+}
+
+char Mfsk_Block(MfskDecoder *d, int8_t tone) {
+    if (tone != d->tone) {
+        d->tone = tone;
+        d->count = 0;
+    }
+    // 每段连续的块只在达到确认块数时处理一次，跨符号边界的单个混叠块不会被确认
+    if (d->count >= MFSK_CONFIRM_BLOCKS || ++d->count < MFSK_CONFIRM_BLOCKS) {
+        return '\0';
+    }
+
+    if (tone < 0) {
+        // 静音：发送端已停，重新等待参考符号
+        d->last = -1;
+        d->half = 0;
+        return '\0';
+    }
+    if (d->last < 0) {
+        d->last = tone;
+        return '\0';
+    }
+
+    uint8_t value = (uint8_t)((tone - d->last - 1 + MFSK_TONES) % MFSK_TONES);
+    if (value > 0x0F) {
+        return '\0';  // 与上一个符号同频，只可能是中间被噪声打断，不是新符号
+    }
+    d->last = tone;
+    if (!d->half) {
+        d->byte = (uint8_t)(value << 4);
+        d->half = 1;
+        return '\0';
+    }
+    d->half = 0;
+    return (char)(d->byte | value);
+}
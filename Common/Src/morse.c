@@ -0,0 +1,33 @@
+#include "morse.h"
+
+const uint8_t MORSE_CODE_TABLE[36] = {
+    0x41, 0x88, 0x8A, 0x64, 0x20, 0x82,  // A B C D E F
+    0x66, 0x80, 0x40, 0x87, 0x65, 0x84,  // G H I J K L
+    0x43, 0x42, 0x67, 0x86, 0x8D, 0x62,  // M N O P Q R
+    0x60, 0x21, 0x61, 0x81, 0x63, 0x89,  // S T U V W X
+    0x8B, 0x8C, 0xBF, 0xAF, 0xA7, 0xA3,  // Y Z 0 1 2 3
+    0xA1, 0xA0, 0xB0, 0xB8, 0xBC, 0xBE,  // 4 5 6 7 8 9
+};
+
+const char MORSE_TREE[MORSE_TREE_SIZE] = {
+    0, 0,  // 0为无效节点，1为根
+    'E', 'T',  // 深度1
+    'I', 'A', 'N', 'M',  // 深度2
+    'S', 'U', 'R', 'W', 'D', 'K', 'G', 'O',  // 深度3
+    'H', 'V', 'F', 0, 'L', 0, 'P', 'J', 'B', 'X', 'C', 'Y', 'Z', 'Q', 0, 0,  // 深度4
+    '5', '4', 0, '3', 0, 0, 0, '2', 0, 0, 0, 0, 0, 0, 0, '1',  // 深度5
+    '6', 0, 0, 0, 0, 0, 0, 0, '7', 0, 0, 0, '8', 0, '9', '0',
+};
+
+uint8_t Morse_Encode(char c) {
+    uint8_t letter = (uint8_t)((c | 0x20) - 'a');  // 大小写统一后的字母序号
+    uint8_t digit = (uint8_t)(c - '0');
+
+    if (letter < 26) {
+        return MORSE_CODE_TABLE[letter];
+    }
+    if (digit < 10) {
+        return MORSE_CODE_TABLE[26 + digit];
+    }
+    return 0;
+}
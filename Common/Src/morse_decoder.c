@@ -0,0 +1,91 @@
+#include "morse_decoder.h"
+
+// 指数滑动平均：估计值向新样本移动 1/2^shift
+static uint32_t Morse_Ewma(uint32_t est, uint32_t sample, uint8_t shift) {
+    return (uint32_t)((int32_t)est + ((int32_t)sample - (int32_t)est) / (1 << shift));
+}
+
+static uint32_t Morse_Clamp(uint32_t us, uint32_t min, uint32_t max) {
+    return us < min ? min : (us > max ? max : us);
+}
+
+void MorseDecoder_Init(MorseDecoder *d, const MorseTiming *t, uint8_t early) {
+    d->dot_us = Morse_Clamp(t->dot_us, MORSE_DOT_MIN_US, MORSE_DOT_MAX_US);
+    d->dash_us = 3 * d->dot_us;
+    d->char_gap_x16 = (uint32_t)((t->dot_us + t->letter_gap_us) * 8ULL / t->dot_us);
+    d->word_gap_x16 = (uint32_t)((t->letter_gap_us + t->word_gap_us) * 8ULL / t->dot_us);
+    d->node = MORSE_TREE_ROOT;
+    d->in_word = 0;
+    d->early = early;
+    d->committed = 0;
+    d->retract = 0;
+}
+
+uint32_t MorseDecoder_Unit(const MorseDecoder *d) {
+    return (d->dot_us + d->dash_us / 3) / 2;
+}
+
+uint8_t MorseDecoder_Mark(MorseDecoder *d, uint32_t us) {
+    // 短于1/4个点视为毛刺；门限不能取得太高，否则发送端突然加速时新的点会被全部丢掉
+    if (us < d->dot_us / 4) {
+        return 0;
+    }
+
+    uint8_t dash = us >= (d->dot_us + d->dash_us) / 2;
+    if (dash) {
+        // 长按等远超划长的按键最多按2倍划长计入，发送端减速时估计仍能逐步跟上
+        uint32_t sample = us < 2 * d->dash_us ? us : 2 * d->dash_us;
+        d->dash_us = Morse_Clamp(Morse_Ewma(d->dash_us, sample, 2), 3 * MORSE_DOT_MIN_US, 3 * MORSE_DOT_MAX_US);
+        d->dot_us = Morse_Ewma(d->dot_us, d->dash_us / 3, 3);
+    } else {
+        d->dot_us = Morse_Clamp(Morse_Ewma(d->dot_us, us, 2), MORSE_DOT_MIN_US, MORSE_DOT_MAX_US);
+        d->dash_us = Morse_Ewma(d->dash_us, 3 * d->dot_us, 3);
+    }
+    if (d->committed) {
+        // 提前输出的字母后面又来了点划，说明判断错了
+        d->committed = 0;
+        d->retract = 1;
+    }
+    d->node = Morse_TreeStep(d->node, dash);
+    return dash + 1;
+}
+
+void MorseDecoder_Space(MorseDecoder *d, uint32_t us) {
+    // 只有点划之间的间隔是1个单位；字母和单词间隔可能被发送端拉长（Farnsworth），不参与估计
+    if (us >= d->dot_us / 4 && us < 2 * MorseDecoder_Unit(d)) {
+        d->dot_us = Morse_Clamp(Morse_Ewma(d->dot_us, us, 2), MORSE_DOT_MIN_US, MORSE_DOT_MAX_US);
+    }
+}
+
+char MorseDecoder_Poll(MorseDecoder *d, uint32_t gap_us) {
+    if (d->retract) {
+        d->retract = 0;
+        return '\b';
+    }
+    if (d->early && !d->committed && Morse_TreeIsLeaf(d->node)) {
+        d->committed = 1;
+        d->in_word = 1;
+        return Morse_TreeChar(d->node);
+    }
+    // 点划已超出码表（节点为0）时立即结束当前字符
+    if (d->node == 0 || (d->node != MORSE_TREE_ROOT && gap_us >= MorseDecoder_CharGapUs(d))) {
+        char letter = d->committed ? '\0' : Morse_TreeChar(d->node);
+        d->node = MORSE_TREE_ROOT;
+        d->committed = 0;
+        d->in_word = 1;
+        if (letter != '\0') {
+            return letter;
+        }
+    }
+    if (d->in_word && d->node == MORSE_TREE_ROOT && gap_us >= MorseDecoder_WordGapUs(d)) {
+        d->in_word = 0;
+        return ' ';
+    }
+    return '\0';
+}
+
+void MorseDecoder_Abort(MorseDecoder *d) {
+    d->node = MORSE_TREE_ROOT;
+    d->committed = 0;
+    d->retract = 0;
+}
@@ -0,0 +1,69 @@
+#include "morse_timeline.h"
+#include "morse.h"
+
+void MorseRun_Init(MorseRunGen *g, const MorseTiming *t) {
+    g->timing = *t;
+    g->bits = 0;
+    g->left = 0;
+    g->mark = 0;
+}
+
+int8_t MorseRun_Next(MorseRunGen *g, MorseCharSource src, void *ctx, uint32_t *us) {
+    if (g->mark) {
+        // 同一字母内的点划之间隔一个单位，字母结束后留字母间隔
+        *us = g->left != 0 ? g->timing.dot_us : g->timing.letter_gap_us;
+        g->mark = 0;
+        return 0;
+    }
+
+    while (g->left == 0) {
+        char c = src(ctx);
+        uint8_t code = Morse_Encode(c);
+
+        if (c == '\0') {
+            return -1;
+        }
+        if (code != 0) {
+            g->bits = MORSE_BITS(code);
+            g->left = MORSE_LEN(code);
+        } else if (c == ' ' || c == '\n') {
+            // 前一个字母已经留了字母间隔，这里补足剩余部分
+            *us = g->timing.word_gap_us - g->timing.letter_gap_us;
+            return 0;
+        }
+        // 其他字符直接跳过
+    }
+
+    g->left--;
+    *us = (1 + ((g->bits >> g->left) & 1U) * 2) * g->timing.dot_us;
+    g->mark = 1;
+    return 1;
+}
+
+static char Morse_StringSource(void *ctx) {
+    const char **p = (const char **)ctx;
+    return **p != '\0' ? *(*p)++ : '\0';
+}
+
+uint16_t Morse_Timeline(const char *text, const MorseTiming *t, uint32_t *runs, uint16_t max) {
+    MorseRunGen g;
+    uint16_t count = 0;
+    uint32_t us;
+    int8_t level;
+
+    MorseRun_Init(&g, t);
+    while ((level = MorseRun_Next(&g, Morse_StringSource, &text, &us)) >= 0) {
+        if ((count & 1U) == (uint16_t)level) {
+            // 与上一段电平相同（字母间隔后接单词间隔），或开头的间隔
+            if (count != 0) {
+                runs[count - 1] += us;
+            }
+            continue;
+        }
+        if (count == max) {
+            break;
+        }
+        runs[count++] = us;
+    }
+    return count;
+}
@@ -0,0 +1,20 @@
+#include "morse_timing.h"
+
+void MorseTiming_Init(MorseTiming *t, uint8_t wpm, uint8_t char_wpm) {
+    if (char_wpm < wpm) {
+        char_wpm = wpm;
+    }
+    // PARIS：每分钟 wpm 个单词，每个单词50个单位，即单位时长 1.2s / wpm
+    t->dot_us = 1200000U / char_wpm;
+
+    if (char_wpm == wpm) {
+        t->letter_gap_us = 3 * t->dot_us;
+        t->word_gap_us = 7 * t->dot_us;
+    } else {
+        // Farnsworth（ARRL）：PARIS 中按字符速度发送的31个单位之外，
+        // 剩下的总时长按 3:7 分给4个字母间隔和1个单词间隔（共19份）
+        uint64_t delay_us = (60000000ULL * char_wpm - 37200000ULL * wpm) / ((uint32_t)wpm * char_wpm);
+        t->letter_gap_us = (uint32_t)(delay_us * 3 / 19);
+        t->word_gap_us = (uint32_t)(delay_us * 7 / 19);
+    }
+}
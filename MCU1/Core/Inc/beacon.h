@@ -0,0 +1,22 @@
+#ifndef _BEACON_H_
+#define _BEACON_H_
+#include <stdint.h>
+
+// 由 codeMC1/beacon.c 生成，请勿手工修改：./beacon "HELLOCYU" 24 24
+// 点长 50000 us，字母间隔 150000 us，单词间隔 350000 us，共 54 段，总时长 4600000 us
+#define BEACON_TEXT "HELLOCYU"  // 原文，MFSK模式下按文本发送
+#define BEACON_DOT_US 50000U
+#define BEACON_RUN_COUNT 54
+
+// 按键、间隔交替（微秒），用 Keyer_Play() 播放
+static const uint32_t BEACON_RUNS[BEACON_RUN_COUNT] = {
+    50000, 50000, 50000, 50000, 50000, 50000, 50000, 150000,
+    50000, 150000, 50000, 50000, 150000, 50000, 50000, 50000,
+    50000, 150000, 50000, 50000, 150000, 50000, 50000, 50000,
+    50000, 150000, 150000, 50000, 150000, 50000, 150000, 150000,
+    150000, 50000, 50000, 50000, 150000, 50000, 50000, 150000,
+    150000, 50000, 50000, 50000, 150000, 50000, 150000, 150000,
+    50000, 50000, 50000, 50000, 150000, 150000,
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef _BEEP_H_
+#define _BEEP_H_
+#include "main.h"
+
+// 1: PA9复用为TIM1_CH2，输出固定频率的PWM方波（无源蜂鸣器，接收端可做窄带检测）
+// 0: PA9为普通输出，高电平时由有源蜂鸣器自激发声，频率不确定
+#define BEEP_USE_PWM 1
+
+//GPIO口定义
+#define BEEP_PIN BUZZER_PIN   // 定义蜂鸣器的引脚
+#define BEEP_PORT BUZZER_PORT // 定义蜂鸣器的端口
+
+// TIM1挂在APB2（84MHz），预分频8后计数频率10.5MHz；16位ARR对应约161Hz~20kHz
+#define BEEP_TIM TIM1
+#define BEEP_CHANNEL TIM_CHANNEL_2
+#define BEEP_TIMER_CLK_HZ 10500000U
+#define BEEP_FREQ_MIN 200U
+#define BEEP_FREQ_MAX 20000U
+
+void BEEP_Init(TIM_HandleTypeDef *htim);//绑定PWM定时器并启动输出（静音）
+// 以下函数只写寄存器、耗时固定，可在中断里调用
+void beep_on(uint32_t freq);   // 以freq（Hz）发声，已在发声时只改变频率
+void beep_off(void);           // 静音，下一个PWM周期起输出保持低电平
+#if BEEP_USE_PWM
+uint32_t beep_tone(uint32_t freq); // 只设置频率不改变开关状态，返回发声时应写入CCR的值
+volatile uint32_t *beep_ccr(void); // 控制开关的寄存器（写beep_tone的返回值发声，写0静音），供DMA直接写入
+#endif
+
+#endif
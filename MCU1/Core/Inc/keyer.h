@@ -0,0 +1,39 @@
+#ifndef _KEYER_H_
+#define _KEYER_H_
+#include "main.h"
+#include "mfsk.h"
+
+// 1: 由DAC1在PA4合成带升余弦包络的正弦音（见 tone.h），TIM6更新事件触发DMA，蜂鸣器不发声
+// 0: 按下面的 KEYER_USE_DMA 驱动蜂鸣器
+#define KEYER_USE_DAC 0
+
+// 1: TIM8更新事件触发DMA写TIM1->CCR2（BEEP_USE_PWM为0时写GPIOA->BSRR），CPU只在半传输/传输完成时填充缓冲
+// 0: 每个点划/间隔进一次TIM5更新中断
+#define KEYER_USE_DMA 1
+
+// MFSK模式（LINK_USE_MFSK，见 mfsk.h）每个符号进一次TIM5中断，由PWM蜂鸣器换频，不使用以上两种方式
+#if LINK_USE_MFSK
+#undef KEYER_USE_DAC
+#define KEYER_USE_DAC 0
+#undef KEYER_USE_DMA
+#define KEYER_USE_DMA 0
+#endif
+
+// 待发送字符队列长度（必须是2的幂）
+#define KEYER_QUEUE_SIZE 128
+
+// DMA模式：每个字对应的时间片（微秒）和双缓冲总长度（字）
+#define KEYER_DMA_TICK_US 250
+#define KEYER_DMA_BUF_LEN 128
+
+void Keyer_Init(TIM_HandleTypeDef *htim);   // 绑定定时器（DAC模式为TIM6，DMA模式为TIM8，否则为TIM5），须在BEEP_Init之后调用
+uint16_t Keyer_Send(const char *str);        // 字符串入队，立即返回实际入队的字符数
+uint16_t Keyer_Write(const char *data, uint16_t len); // 同上，按长度入队，用于串口收到的数据
+// 播放预先生成的游程数组（按键、间隔交替，单位微秒，见 Morse_Timeline），空闲时才能开始，返回是否已开始；MFSK模式下不支持
+uint8_t Keyer_Play(const uint32_t *runs, uint16_t count);
+uint8_t Keyer_IsBusy(void);                  // 队列或当前字符尚未发送完毕时返回1
+void Keyer_TIM_PeriodElapsed(void);          // 在TIM5更新中断里调用，推进状态机
+void Keyer_DMA_HalfCplt(DMA_HandleTypeDef *hdma); // DMA前半缓冲播放完毕
+void Keyer_DMA_Cplt(DMA_HandleTypeDef *hdma);     // DMA后半缓冲播放完毕
+
+#endif
@@ -49,6 +49,8 @@ extern "C" {
 
 /* USER CODE END EM */
 
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
+
 /* Exported functions prototypes ---------------------------------------------*/
 void Error_Handler(void);
 
@@ -69,6 +71,10 @@ void Error_Handler(void);
 #define SWO_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
+#define BUZZER_PIN GPIO_PIN_9
+#define BUZZER_PORT GPIOA
+
+#define BEACON_INTERVAL_US 3000000U      // 信标发送完毕后的等待时间（微秒）
 
 /* USER CODE END Private defines */
 
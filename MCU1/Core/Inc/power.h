@@ -0,0 +1,22 @@
+#ifndef _POWER_H_
+#define _POWER_H_
+#include "main.h"
+
+// 主循环无事可做时的低功耗等待。
+// SLEEP：只停CPU，定时器、DMA照常工作，按键音和点划时序由硬件产生，不受影响；停掉SysTick，
+//        由外设中断或TIM2 CH1比较在截止时刻唤醒。
+// STOP：等待信标且键控器空闲时使用，除RTC外时钟全停；RTC唤醒定时器在截止时刻前唤醒，
+//       PC13按键和PA3（串口接收）的下降沿也可唤醒，醒来后重新打开PLL，按RTC子秒计数补上TIM2停走的时间。
+//       唤醒要约0.3ms，期间串口收到的第一个字符会丢失
+#define POWER_USE_STOP 1          // 0: 只用SLEEP（例如调试时不希望断开调试器）
+#define POWER_STOP_MIN_US 20000   // 距截止时刻不足20ms时只进SLEEP
+#define POWER_STOP_WAKE_US 2000   // RTC提前唤醒的余量，剩余部分用SLEEP+TIM2比较补足
+#define POWER_STOP_MAX_US 4000000 // 单次STOP最长时间，须小于RTC子秒计数回绕周期（约8秒）的一半
+
+void Power_Init(TIM_HandleTypeDef *htim); // 绑定TIM2（须已启动）并配置RTC，用TIM2校准RTC时钟约0.1秒
+void Power_Wake(void);                    // 在中断回调里调用：主循环有新工作，下一次等待立即返回
+void Power_Sleep(void);                   // SLEEP直到任一中断
+void Power_Wait(uint32_t deadline, uint8_t allow_stop); // 等到截止时刻（Timebase）或任一中断，allow_stop时可进入STOP
+void Power_RtcWakeup(void);               // 在RTC_WKUP中断里调用
+
+#endif
@@ -55,6 +55,15 @@ void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
+void RTC_WKUP_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void TIM2_IRQHandler(void);
+void USART2_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+void TIM5_IRQHandler(void);
+void DMA2_Stream1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
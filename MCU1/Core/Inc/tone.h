@@ -0,0 +1,24 @@
+#ifndef _TONE_H_
+#define _TONE_H_
+#include "main.h"
+#include "morse.h"
+
+// DAC1（PA4）正弦音合成：TIM6更新事件触发DMA把采样写入DAC->DHR12R1，
+// 按键/松键时包络按升余弦在 TONE_RAMP_CYCLES 个载波周期内渐变，避免硬切换造成频谱展宽
+#define TONE_SAMPLES_PER_CYCLE 42   // 每个载波周期的采样数，2kHz时采样率84kHz，TIM6正好每1000个时钟一次
+#define TONE_RATE_HZ (MORSE_TONE_HZ * TONE_SAMPLES_PER_CYCLE)
+#define TONE_RAMP_CYCLES 10         // 上升/下降沿占用的载波周期数（2kHz时为5ms）
+#define TONE_BUF_CYCLES 16          // DMA双缓冲总长度（载波周期），每半缓冲进一次中断
+#define TONE_MIDSCALE 2048          // 静音时的DAC输出（中点）
+#define TONE_AMPLITUDE 2000         // 正弦峰值（DAC码）
+
+// 取下一段游程及其时长（微秒），返回1为按键，0为间隔，-1表示已无内容
+typedef int8_t (*ToneRunSource)(uint32_t *us);
+
+void Tone_Init(TIM_HandleTypeDef *htim);   // 绑定TIM6，生成波形表，使能DAC并输出中点电平
+// 开始按游程合成，一开始就没有内容时返回0；播放完毕后在DMA中断里调用done
+uint8_t Tone_Start(ToneRunSource next, void (*done)(void));
+void Tone_DMA_HalfCplt(DMA_HandleTypeDef *hdma); // DMA前半缓冲播放完毕
+void Tone_DMA_Cplt(DMA_HandleTypeDef *hdma);     // DMA后半缓冲播放完毕
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _UART_RX_H_
+#define _UART_RX_H_
+#include "main.h"
+
+// USART2 接收：DMA循环写入缓冲，线路空闲（IDLE）、半满、全满时更新可读位置
+// 缓冲长度（必须是2的幂），即主循环未取走时最多可积压的字节数。
+// ST-LINK虚拟串口没有RTS，无法让主机暂停；积压超过缓冲长度时DMA会覆盖未读数据，
+// 此时丢弃全部积压并计数，主机一次发送不应超过缓冲长度，或按键控速度分段发送
+#define UART_RX_BUF_SIZE 256
+
+void UartRx_Init(UART_HandleTypeDef *huart);  // 启动DMA接收
+uint16_t UartRx_Peek(const uint8_t **data);    // 取得连续可读的一段，返回其长度，无数据返回0
+void UartRx_Consume(uint16_t len);             // 丢弃已处理的len个字节
+void UartRx_Event(uint16_t pos);               // 在接收事件回调里调用，pos为DMA已写到的位置
+uint32_t UartRx_Dropped(void);                 // 因溢出或出错丢弃的字节数
+void UartRx_Error(void);                       // 在UART错误回调里调用，由下一次 UartRx_Peek 重新启动接收
+
+#endif
@@ -0,0 +1,62 @@
+#include "beep.h"
+#include "morse.h"
+
+#if BEEP_USE_PWM
+static TIM_HandleTypeDef *beep_htim;
+static uint32_t beep_duty = 0;  // 当前频率下50%占空比对应的CCR值
+
+void BEEP_Init(TIM_HandleTypeDef *htim) {
+    beep_htim = htim;
+    beep_tone(MORSE_TONE_HZ);
+    __HAL_TIM_SET_COMPARE(beep_htim, BEEP_CHANNEL, 0);
+    HAL_TIM_PWM_Start(beep_htim, BEEP_CHANNEL);
+}
+
+// ARR和CCR都开启了预装载，新值在下一个更新事件才生效，方波不会出现残缺周期
+uint32_t beep_tone(uint32_t freq) {
+    if (freq < BEEP_FREQ_MIN) {
+        freq = BEEP_FREQ_MIN;
+    } else if (freq > BEEP_FREQ_MAX) {
+        freq = BEEP_FREQ_MAX;
+    }
+    uint32_t period = BEEP_TIMER_CLK_HZ / freq;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    beep_duty = period / 2;
+    __HAL_TIM_SET_AUTORELOAD(beep_htim, period - 1);
+    if (__HAL_TIM_GET_COMPARE(beep_htim, BEEP_CHANNEL) != 0) {
+        __HAL_TIM_SET_COMPARE(beep_htim, BEEP_CHANNEL, beep_duty);
+    }
+    __set_PRIMASK(primask);
+
+    return beep_duty;
+}
+
+void beep_on(uint32_t freq) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    __HAL_TIM_SET_COMPARE(beep_htim, BEEP_CHANNEL, beep_tone(freq));
+    __set_PRIMASK(primask);
+}
+
+void beep_off(void) {
+    __HAL_TIM_SET_COMPARE(beep_htim, BEEP_CHANNEL, 0);
+}
+
+volatile uint32_t *beep_ccr(void) {
+    return &BEEP_TIM->CCR2;
+}
+#else
+void BEEP_Init(TIM_HandleTypeDef *htim) {
+    beep_off();
+}
+
+void beep_on(uint32_t freq) {
+    BEEP_PORT->BSRR = BEEP_PIN;
+}
+
+void beep_off(void) {
+    BEEP_PORT->BSRR = (uint32_t)BEEP_PIN << 16U;
+}
+#endif
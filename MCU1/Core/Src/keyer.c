@@ -0,0 +1,268 @@
+#include "keyer.h"
+#include "beep.h"
+#include "morse.h"
+#include "morse_timeline.h"
+#include "tone.h"
+#include "ring_buffer.h"
+#include <string.h>
+
+#if LINK_USE_MFSK && !BEEP_USE_PWM
+#error "MFSK需要PWM蜂鸣器换频（BEEP_USE_PWM）"
+#endif
+
+#if BEEP_USE_PWM
+// DMA写TIM1->CCR2：静音为0，发声值由当前频率决定（见 beep_tone）
+#define KEYER_WORD_OFF 0U
+#else
+// 蜂鸣器开/关对应的BSRR写入值
+#define KEYER_WORD_ON  ((uint32_t)BUZZER_PIN)
+#define KEYER_WORD_OFF ((uint32_t)BUZZER_PIN << 16U)
+#endif
+
+static TIM_HandleTypeDef *keyer_htim;
+static char keyer_queue[KEYER_QUEUE_SIZE];
+static Ring keyer_ring;                   // 主循环放入，中断取出
+static volatile uint8_t keyer_running = 0;
+static MorseTiming keyer_timing;          // 点划和间隔时长
+#if LINK_USE_MFSK
+static MfskEncoder keyer_mfsk;            // 队列中文本的MFSK符号编码器
+#else
+static MorseRunGen keyer_gen;             // 队列中文本的游程生成器
+static const uint32_t *keyer_runs = NULL; // 正在播放的预生成游程
+static uint16_t keyer_runs_left = 0;
+static uint8_t keyer_runs_level = 0;      // 下一段预生成游程的电平
+#endif
+
+#if KEYER_USE_DMA && !KEYER_USE_DAC
+static uint32_t keyer_dma_buf[KEYER_DMA_BUF_LEN];
+static uint32_t keyer_run_ticks = 0;      // 当前段剩余的时间片
+static uint32_t keyer_run_word = KEYER_WORD_OFF;
+static uint32_t keyer_word_on;            // 按键时写入的值
+static uint8_t keyer_idle_halves = 0;     // 连续填充的全空闲半缓冲数
+#endif
+
+// 从队列取下一个字符，队列为空返回 '\0'
+static char Keyer_QueueSource(void *ctx) {
+    if (Ring_Count(&keyer_ring) == 0) {
+        return '\0';
+    }
+    char c = keyer_queue[Ring_Tail(&keyer_ring)];
+    Ring_Consume(&keyer_ring, 1);
+    return c;
+}
+
+#if !LINK_USE_MFSK
+// 生成下一段电平及其持续时间（微秒），即消息的游程时间线：
+// 返回1为按键，0为间隔，-1表示已无内容
+static int8_t Keyer_NextRun(uint32_t *us) {
+    if (keyer_runs_left != 0) {
+        int8_t level = keyer_runs_level;
+        *us = *keyer_runs++;
+        keyer_runs_left--;
+        keyer_runs_level ^= 1;
+        return level;
+    }
+    return MorseRun_Next(&keyer_gen, Keyer_QueueSource, NULL, us);
+}
+#endif
+
+#if KEYER_USE_DAC
+// 播放完毕时由DMA中断调用
+static void Keyer_Stopped(void) {
+    keyer_running = 0;
+}
+
+static void Keyer_Start(void) {
+    if (Tone_Start(Keyer_NextRun, Keyer_Stopped)) {
+        keyer_running = 1;
+    }
+}
+#elif KEYER_USE_DMA
+// 把时间线展开成逐时间片的BSRR字，返回本次是否填入了任何待播放内容
+static uint8_t Keyer_Fill(uint32_t *buf, uint16_t len) {
+    uint8_t active = 0;
+
+    for (uint16_t i = 0; i < len; i++) {
+        while (keyer_run_ticks == 0) {
+            uint32_t us;
+            int8_t level = Keyer_NextRun(&us);
+            if (level < 0) {
+                keyer_run_word = KEYER_WORD_OFF;
+                break;
+            }
+            keyer_run_word = level ? keyer_word_on : KEYER_WORD_OFF;
+            keyer_run_ticks = (us + KEYER_DMA_TICK_US / 2) / KEYER_DMA_TICK_US;
+        }
+        if (keyer_run_ticks != 0) {
+            keyer_run_ticks--;
+            active = 1;
+        }
+        buf[i] = keyer_run_word;
+    }
+    return active;
+}
+
+static void Keyer_Refill(uint32_t *buf) {
+    if (Keyer_Fill(buf, KEYER_DMA_BUF_LEN / 2)) {
+        keyer_idle_halves = 0;
+    } else if (++keyer_idle_halves >= 2) {
+        // 两个半缓冲都只剩空闲电平，消息已播放完毕
+        __HAL_TIM_DISABLE_DMA(keyer_htim, TIM_DMA_UPDATE);
+        HAL_TIM_Base_Stop(keyer_htim);
+        HAL_DMA_Abort_IT(keyer_htim->hdma[TIM_DMA_ID_UPDATE]);
+        keyer_running = 0;
+    }
+}
+
+void Keyer_DMA_HalfCplt(DMA_HandleTypeDef *hdma) {
+    Keyer_Refill(&keyer_dma_buf[0]);
+}
+
+void Keyer_DMA_Cplt(DMA_HandleTypeDef *hdma) {
+    Keyer_Refill(&keyer_dma_buf[KEYER_DMA_BUF_LEN / 2]);
+}
+
+static void Keyer_Start(void) {
+#if BEEP_USE_PWM
+    volatile uint32_t *dst = beep_ccr();
+    keyer_word_on = beep_tone(MORSE_TONE_HZ);
+#else
+    volatile uint32_t *dst = &BUZZER_PORT->BSRR;
+    keyer_word_on = KEYER_WORD_ON;
+#endif
+    keyer_run_ticks = 0;
+    keyer_idle_halves = 0;
+    if (!Keyer_Fill(keyer_dma_buf, KEYER_DMA_BUF_LEN)) {
+        return;
+    }
+    keyer_running = 1;
+
+    DMA_HandleTypeDef *hdma = keyer_htim->hdma[TIM_DMA_ID_UPDATE];
+    hdma->XferHalfCpltCallback = Keyer_DMA_HalfCplt;
+    hdma->XferCpltCallback = Keyer_DMA_Cplt;
+    HAL_DMA_Start_IT(hdma, (uint32_t)keyer_dma_buf, (uint32_t)dst, KEYER_DMA_BUF_LEN);
+    __HAL_TIM_SET_COUNTER(keyer_htim, 0);
+    __HAL_TIM_ENABLE_DMA(keyer_htim, TIM_DMA_UPDATE);
+    HAL_TIM_Base_Start(keyer_htim);
+}
+#else
+// 设置下一段持续时间（微秒），定时器已配置为1MHz计数
+static void Keyer_Schedule(uint32_t us) {
+    __HAL_TIM_SET_AUTORELOAD(keyer_htim, us - 1);
+    __HAL_TIM_SET_COUNTER(keyer_htim, 0);
+}
+
+#if LINK_USE_MFSK
+// 换到下一个符号的频率，返回0表示已无内容
+static uint8_t Keyer_Step(void) {
+    int8_t tone = Mfsk_Next(&keyer_mfsk, Keyer_QueueSource, NULL);
+
+    if (tone < 0) {
+        beep_off();
+        return 0;
+    }
+    beep_on(MFSK_TONE_HZ(tone));
+    Keyer_Schedule(MFSK_SYMBOL_US);
+    return 1;
+}
+#else
+// 输出下一段，返回0表示已无内容
+static uint8_t Keyer_Step(void) {
+    uint32_t us;
+    int8_t level = Keyer_NextRun(&us);
+
+    if (level < 0) {
+        return 0;
+    }
+    if (level) {
+        beep_on(MORSE_TONE_HZ);
+    } else {
+        beep_off();
+    }
+    Keyer_Schedule(us);
+    return 1;
+}
+#endif
+
+void Keyer_TIM_PeriodElapsed(void) {
+    if (!Keyer_Step()) {
+        // 队列已空，停止定时器
+        HAL_TIM_Base_Stop_IT(keyer_htim);
+        keyer_running = 0;
+    }
+}
+
+static void Keyer_Start(void) {
+    if (Keyer_Step()) {
+        keyer_running = 1;
+        __HAL_TIM_CLEAR_FLAG(keyer_htim, TIM_FLAG_UPDATE);
+        HAL_TIM_Base_Start_IT(keyer_htim);
+    }
+}
+#endif
+
+void Keyer_Init(TIM_HandleTypeDef *htim) {
+    keyer_htim = htim;
+    if (!Ring_Init(&keyer_ring, KEYER_QUEUE_SIZE)) {
+        Error_Handler();
+    }
+    MorseTiming_Init(&keyer_timing, MORSE_WPM, MORSE_CHAR_WPM);
+    beep_off();
+#if KEYER_USE_DAC
+    Tone_Init(htim);
+#endif
+}
+
+uint16_t Keyer_Send(const char *str) {
+    return Keyer_Write(str, strlen(str));
+}
+
+uint16_t Keyer_Write(const char *data, uint16_t len) {
+    uint16_t count = 0;
+    uint16_t room = Ring_Free(&keyer_ring);
+
+    // 队列满时多出的字符不入队
+    while (count < len && count < room) {
+        keyer_queue[(Ring_Head(&keyer_ring) + count) & (KEYER_QUEUE_SIZE - 1)] = data[count];
+        count++;
+    }
+    Ring_Publish(&keyer_ring, count);
+
+    // 空闲时由这里启动，之后全部由中断推进
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!keyer_running) {
+#if LINK_USE_MFSK
+        Mfsk_EncoderInit(&keyer_mfsk);
+#else
+        MorseRun_Init(&keyer_gen, &keyer_timing);
+#endif
+        Keyer_Start();
+    }
+    __set_PRIMASK(primask);
+
+    return count;
+}
+
+uint8_t Keyer_Play(const uint32_t *runs, uint16_t count) {
+    uint8_t started = 0;
+#if !LINK_USE_MFSK  // 游程是摩尔斯的按键时序，MFSK模式下不播放
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!keyer_running) {
+        keyer_runs = runs;
+        keyer_runs_left = count;
+        keyer_runs_level = 1;
+        MorseRun_Init(&keyer_gen, &keyer_timing);
+        Keyer_Start();
+        started = 1;
+    }
+    __set_PRIMASK(primask);
+#endif
+
+    return started;
+}
+
+uint8_t Keyer_IsBusy(void) {
+    return keyer_running || Ring_Count(&keyer_ring) != 0;
+}
@@ -1,66 +1,49 @@
 
 #include "main.h"
-
-
-#define BUZZER_PIN GPIO_PIN_9
-#define BUZZER_PORT GPIOA
+#include "keyer.h"
+#include "beep.h"
+#include "tone.h"
+#include "morse.h"
+#include "uart_rx.h"
+#include "beacon.h"
+#include "timebase.h"
+#include "power.h"
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim5;
+TIM_HandleTypeDef htim6;
+TIM_HandleTypeDef htim8;
+DMA_HandleTypeDef hdma_tim6_up;
+DMA_HandleTypeDef hdma_tim8_up;
 
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
 static void MX_USART2_UART_Init(void);
+static void MX_DMA_Init(void);
+#if BEEP_USE_PWM
+static void MX_TIM1_Init(void);
+#endif
+static void MX_TIM2_Init(void);
+#if KEYER_USE_DAC
+static void MX_TIM6_Init(void);
+#elif KEYER_USE_DMA
+static void MX_TIM8_Init(void);
+#else
+static void MX_TIM5_Init(void);
+#endif
 //////////////////////////////////////////////////////////
 //section ver1.2
+// 入队后立即返回，点划由定时器按时序输出
 void MorseCodeChar(char c) {
-    const char *morseCode;
-    // 转换大写字母到摩斯电码
-    if (c >= 'A' && c <= 'Z') {
-        morseCode = MORSE_CODE_TABLE[c - 'A'];
-    }
-    // 转换数字到摩斯电码
-    else if (c >= '0' && c <= '9') {
-        morseCode = MORSE_CODE_TABLE[c - '0' + 26];
-    }
-    // 如果字符不是字母或数字，则跳过
-    else {
-        return;
-    }
-
-    // 输出摩斯电码
-    for (int i = 0; morseCode[i] != '\0'; i++) {
-        if (morseCode[i] == '.') {
-            dot();
-        } else if (morseCode[i] == '-') {
-            dash();
-        }
-        letterSpace();  // 每输出一个点或划后添加一个字符间隔
-    }
-    wordSpace();  // 每个字母后添加一个单词间隔，以区分字母
+    char str[2] = {c, '\0'};
+    Keyer_Send(str);
 }
 
 void MorseCodeString(const char *str) {
-    for (int i = 0; str[i] != '\0'; i++) {
-        MorseCodeChar(toupper(str[i]));  // 将字符转换为大写并发送
-    }
-}
-
-void dot(void) {
-    HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_SET); // 开启蜂鸣器
-    HAL_Delay(DOT_LENGTH); // 点的持续时间
-    HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_RESET); // 关闭蜂鸣器
-    HAL_Delay(DOT_LENGTH); // 点后的间隔，确保点和划之间有分隔
-}
-
-void dash(void) {
-    HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_SET); // 开启蜂鸣器
-    HAL_Delay(DASH_LENGTH); // 划的持续时间
-    HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_RESET); // 关闭蜂鸣器
-    HAL_Delay(DOT_LENGTH); // 划后的间隔，为了简化，这里也使用点的长度
-}
-
-void letterSpace(void) {
-    HAL_Delay(CHAR_GAP_MS); // 字母间的间隔
+    Keyer_Send(str);
 }
 //////////////////////////////////////////////////////////
 //section ver1.2
@@ -71,26 +54,71 @@ int main(void)
 	HAL_Init();
 	SystemClock_Config();
 	MX_GPIO_Init();
+	MX_DMA_Init();
 	MX_USART2_UART_Init();
-	HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, GPIO_PIN_RESET);
+	UartRx_Init(&huart2);
+#if BEEP_USE_PWM
+	MX_TIM1_Init();
+#endif
+	BEEP_Init(&htim1);
+	MX_TIM2_Init();
+	HAL_TIM_Base_Start(&htim2);  // 微秒时钟，见 timebase.h
+	Power_Init(&htim2);
+#if KEYER_USE_DAC
+	MX_TIM6_Init();
+	Keyer_Init(&htim6);
+#elif KEYER_USE_DMA
+	MX_TIM8_Init();
+	Keyer_Init(&htim8);
+#else
+	MX_TIM5_Init();
+	Keyer_Init(&htim5);
+#endif
+
+	uint32_t beacon_due = Timebase_Now();  // 上电后立即发送第一次
+	uint8_t host_seen = 0;  // 收到过串口数据后不再自动发送信标
 
   while (1)
   {
 	  //////////////////////////////////////////////////////////
 	  //section ver1.2
-	  MorseCodeString("HELLOCYU");  // 发送字符串
-	  HAL_Delay(3000); // 消息发送完毕后等待3秒
+	  // 串口收到的文本按键控队列的空余量转入，队列满时留在接收缓冲里下次再取
+	  const uint8_t *rx;
+	  uint16_t rx_len = UartRx_Peek(&rx);
+	  if (rx_len != 0) {
+		  host_seen = 1;
+		  UartRx_Consume(Keyer_Write((const char*)rx, rx_len));
+	  }
+
+	  if (Keyer_IsBusy()) {
+		  beacon_due = Timebase_After(BEACON_INTERVAL_US);
+	  } else if (!host_seen && Timebase_Reached(beacon_due)) {
+#if LINK_USE_MFSK
+		  Keyer_Send(BEACON_TEXT);  // 消息发送完毕3秒后重新发送信标
+#else
+		  Keyer_Play(BEACON_RUNS, BEACON_RUN_COUNT);  // 消息发送完毕3秒后重新发送预生成的信标
+#endif
+	  }
 	  //////////////////////////////////////////////////////////
 	  //section Ver1.1
-	  if (HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13)==0){
-
-	  		  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, GPIO_PIN_SET);
-	  		  while (HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13)==0);
-	  	  }
-	  else{
-		  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_9, GPIO_PIN_RESET);
+	  // 发送信标期间蜂鸣器由键控器控制
+	  uint8_t key_down = 0;
+	  if (!Keyer_IsBusy()) {
+		  if (HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13)==0){
+			  key_down = 1;
+			  beep_on(MORSE_TONE_HZ);
+		  }
+		  else{
+			  beep_off();
+		  }
 	  }
 
+	  // 无事可做时休眠到下一个中断：等待信标时可进入STOP，发送中或按着按键只进SLEEP（定时器和DMA照常工作）
+	  if (!host_seen && !Keyer_IsBusy()) {
+		  Power_Wait(beacon_due, !key_down);
+	  } else {
+		  Power_Sleep();
+	  }
   }
   /* USER CODE END 3 */
 }
@@ -169,6 +197,235 @@ static void MX_USART2_UART_Init(void)
 }
 
 
+#if BEEP_USE_PWM
+/**
+  * @brief TIM1 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM1_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+  TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = {0};
+
+  /* 84MHz / 8 = 10.5MHz；ARR由 beep_tone 按频率重装，CCR2为0时静音 */
+  htim1.Instance = TIM1;
+  htim1.Init.Prescaler = 8 - 1;
+  htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim1.Init.Period = BEEP_TIMER_CLK_HZ / MORSE_TONE_HZ - 1;
+  htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim1.Init.RepetitionCounter = 0;
+  htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&htim1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim1, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_PWM_Init(&htim1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sConfigOC.OCMode = TIM_OCMODE_PWM1;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCNPolarity = TIM_OCNPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
+  sConfigOC.OCNIdleState = TIM_OCNIDLESTATE_RESET;
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
+  sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
+  sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
+  sBreakDeadTimeConfig.DeadTime = 0;
+  sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
+  sBreakDeadTimeConfig.BreakPolarity = TIM_BREAKPOLARITY_HIGH;
+  sBreakDeadTimeConfig.AutomaticOutput = TIM_AUTOMATICOUTPUT_DISABLE;
+  if (HAL_TIMEx_ConfigBreakDeadTime(&htim1, &sBreakDeadTimeConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  HAL_TIM_MspPostInit(&htim1);
+}
+
+#endif
+
+/**
+  * @brief TIM2 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM2_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  /* 84MHz / 84 = 1MHz，32位计数器自由运行，约71分钟回绕一次 */
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = 84 - 1;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = 0xFFFFFFFF;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* CH1 只作定时比较（不输出到引脚），SLEEP时在截止时刻唤醒，见 power.h */
+  sConfigOC.OCMode = TIM_OCMODE_TIMING;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if (HAL_TIM_OC_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+#if KEYER_USE_DAC
+/**
+  * @brief TIM6 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM6_Init(void)
+{
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* 84MHz / TONE_RATE_HZ，每个更新事件触发DMA向DAC写一个采样 */
+  htim6.Instance = TIM6;
+  htim6.Init.Prescaler = 0;
+  htim6.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim6.Init.Period = 84000000 / TONE_RATE_HZ - 1;
+  htim6.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&htim6) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim6, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+#elif !KEYER_USE_DMA
+/**
+  * @brief TIM5 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM5_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+
+  /* 84MHz / 84 = 1MHz，每个计数1us；ARR由键控器按每段时长重装 */
+  htim5.Instance = TIM5;
+  htim5.Init.Prescaler = 84 - 1;
+  htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim5.Init.Period = 0xFFFFFFFF;
+  htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim5) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim5, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+
+#else
+/**
+  * @brief TIM8 Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_TIM8_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+
+  /* 84MHz / 84 = 1MHz，每 KEYER_DMA_TICK_US 产生一次更新事件触发DMA */
+  htim8.Instance = TIM8;
+  htim8.Init.Prescaler = 84 - 1;
+  htim8.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim8.Init.Period = KEYER_DMA_TICK_US - 1;
+  htim8.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim8.Init.RepetitionCounter = 0;
+  htim8.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&htim8) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim8, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+#endif
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+#if !KEYER_USE_DAC && KEYER_USE_DMA
+  __HAL_RCC_DMA2_CLK_ENABLE();
+#endif
+
+  /* DMA interrupt init */
+#if KEYER_USE_DAC
+  /* DMA1_Stream1_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+#endif
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+#if !KEYER_USE_DAC && KEYER_USE_DMA
+  /* DMA2_Stream1_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream1_IRQn, 1, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream1_IRQn);
+#endif
+
+}
+
 static void MX_GPIO_Init(void)
 {
   GPIO_InitTypeDef GPIO_InitStruct = {0};
@@ -186,7 +443,7 @@ static void MX_GPIO_Init(void)
 
   /*Configure GPIO pin : PC13 */
   GPIO_InitStruct.Pin = GPIO_PIN_13;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
@@ -197,19 +454,57 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
+#if !BEEP_USE_PWM
   /*Configure GPIO pin : PA9 */
   GPIO_InitStruct.Pin = GPIO_PIN_9;
   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
   HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+#endif
+
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 
 /* USER CODE BEGIN MX_GPIO_Init_2 */
 /* USER CODE END MX_GPIO_Init_2 */
 }
 
 /* USER CODE BEGIN 4 */
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+#if !KEYER_USE_DAC && !KEYER_USE_DMA
+  if (htim->Instance == TIM5)
+  {
+    Keyer_TIM_PeriodElapsed();
+  }
+#endif
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  if (huart->Instance == USART2)
+  {
+    UartRx_Event(Size);
+    Power_Wake();
+  }
+}
 
+// PC13按键按下/松开，或STOP期间PA3收到起始位
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+  Power_Wake();
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART2)
+  {
+    UartRx_Error();
+    Power_Wake();
+  }
+}
 /* USER CODE END 4 */
 
 /**
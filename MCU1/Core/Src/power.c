@@ -0,0 +1,271 @@
+#include "power.h"
+#include "timebase.h"
+
+// RTC只用作STOP期间的时钟：异步分频8，子秒计数在LSE时为4096Hz（约244us），15位约8秒回绕一次，不使用日历
+#define POWER_RTC_PREDIV_A 7
+#define POWER_RTC_PREDIV_S 32767
+#define POWER_RTC_SS_MASK 0x7FFFU
+#define POWER_CAL_US 100000U  // 用TIM2校准RTC子秒计数的时长
+#define POWER_LSE_WAIT_MS 250U  // LSE起振最多等这么久，没有焊晶振的板子不必等HAL默认的5秒
+
+static TIM_HandleTypeDef *power_htim;
+static volatile uint8_t power_wake = 0;
+static uint32_t power_tick_rem;   // 停掉SysTick期间不足1ms、尚未补给 HAL_GetTick 的微秒数
+
+#if POWER_USE_STOP
+static uint32_t power_tick_q16;   // 每个RTC子秒计数的微秒数（Q16）
+
+static void Power_RtcUnlock(void) {
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+static void Power_RtcLock(void) {
+    RTC->WPR = 0xFF;
+}
+
+// 直接读子秒计数（已设置BYPSHAD），读到跳变中间时重读
+static uint32_t Power_RtcTicks(void) {
+    uint32_t a, b = RTC->SSR;
+
+    do {
+        a = b;
+        b = RTC->SSR;
+    } while (a != b);
+    return a;
+}
+
+// 等到子秒计数跳变，此时刻与TIM2的对应关系误差只有一两个总线周期
+static uint32_t Power_RtcEdge(void) {
+    uint32_t start = Power_RtcTicks();
+    uint32_t ticks;
+
+    while ((ticks = Power_RtcTicks()) == start) {
+    }
+    return ticks;
+}
+
+static uint32_t Power_TicksToUs(uint32_t ticks) {
+    return (uint32_t)(((uint64_t)ticks * power_tick_q16) >> 16);
+}
+
+static uint32_t Power_UsToTicks(uint32_t us) {
+    return (uint32_t)(((uint64_t)us << 16) / power_tick_q16);
+}
+
+// 打开LSE并等它起振，超时则关掉返回0。热复位时LSE一直在走，立即返回
+static uint8_t Power_LseStart(void) {
+    uint32_t start = HAL_GetTick();
+
+    __HAL_RCC_LSE_CONFIG(RCC_LSE_ON);
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_LSERDY) == 0) {
+        if (HAL_GetTick() - start >= POWER_LSE_WAIT_MS) {
+            __HAL_RCC_LSE_CONFIG(RCC_LSE_OFF);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// RTC时钟优先用LSE（Nucleo上的32.768kHz晶振），短时间内未起振（没有晶振，或冷启动起振较慢）时用LSI；
+// 两者都在初始化时用TIM2校准，LSI只是温漂大些
+static void Power_RtcInit(void) {
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+    RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+
+    HAL_PWR_EnableBkUpAccess();
+    // 上次用的不是LSE时先复位备份域：否则等LSE起振后 HAL_RCCEx_PeriphCLKConfig 切换时钟源时才复位，
+    // LSE要重新起振，HAL又按默认的5秒等它
+    uint32_t rtcsel = RCC->BDCR & RCC_BDCR_RTCSEL;
+    if (rtcsel != 0 && rtcsel != RCC_RTCCLKSOURCE_LSE) {
+        __HAL_RCC_BACKUPRESET_FORCE();
+        __HAL_RCC_BACKUPRESET_RELEASE();
+    }
+    PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+    PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
+    if (!Power_LseStart()) {
+        RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSI;
+        RCC_OscInitStruct.LSIState = RCC_LSI_ON;
+        RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+        if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+            Error_Handler();
+        }
+        PeriphClkInitStruct.RTCClockSelection = RCC_RTCCLKSOURCE_LSI;
+    }
+    if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK) {
+        Error_Handler();
+    }
+    __HAL_RCC_RTC_ENABLE();
+
+    Power_RtcUnlock();
+    RTC->ISR = 0xFFFFFFFFU;  // 置INIT，其余标志写1无影响
+    while ((RTC->ISR & RTC_ISR_INITF) == 0) {
+    }
+    RTC->PRER = POWER_RTC_PREDIV_S;  // 同步、异步分频须分两次写
+    RTC->PRER = (POWER_RTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos) | POWER_RTC_PREDIV_S;
+    RTC->ISR &= ~RTC_ISR_INIT;
+    // 唤醒定时器时钟为RTCCLK/16（WUCKSEL=000），即子秒计数的一半
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUCKSEL);
+    RTC->CR |= RTC_CR_BYPSHAD | RTC_CR_WUTIE;
+    Power_RtcLock();
+
+    // RTC唤醒经EXTI线22的上升沿
+    EXTI->RTSR |= EXTI_RTSR_TR22;
+    EXTI->IMR |= EXTI_IMR_MR22;
+    HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+}
+
+static void Power_RtcWakeupIn(uint32_t ticks) {
+    Power_RtcUnlock();
+    RTC->CR &= ~RTC_CR_WUTE;
+    while ((RTC->ISR & RTC_ISR_WUTWF) == 0) {
+    }
+    RTC->WUTR = ticks - 1U;
+    RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT);
+    RTC->CR |= RTC_CR_WUTE;
+    Power_RtcLock();
+}
+
+static void Power_RtcWakeupStop(void) {
+    Power_RtcUnlock();
+    RTC->CR &= ~RTC_CR_WUTE;
+    Power_RtcLock();
+    Power_RtcWakeup();
+}
+
+// STOP唤醒后系统时钟为HSI，PLL的配置仍保留，只需重新打开并切换，不必再走一遍 SystemClock_Config
+static void Power_RestoreClock(void) {
+    __HAL_RCC_PLL_ENABLE();
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY) == 0) {
+    }
+    __HAL_RCC_SYSCLK_CONFIG(RCC_SYSCLKSOURCE_PLLCLK);
+    while (__HAL_RCC_GET_SYSCLK_SOURCE() != RCC_SYSCLKSOURCE_STATUS_PLLCLK) {
+    }
+}
+#endif
+
+void Power_RtcWakeup(void) {
+    RTC->ISR = ~(RTC_ISR_WUTF | RTC_ISR_INIT);
+    EXTI->PR = EXTI_PR_PR22;
+}
+
+void Power_Init(TIM_HandleTypeDef *htim) {
+    power_htim = htim;
+#if POWER_USE_STOP
+    Power_RtcInit();
+
+    uint32_t s0 = Power_RtcEdge();
+    uint32_t c0 = Timebase_Now();
+    while (Timebase_Elapsed(c0) < POWER_CAL_US) {
+    }
+    uint32_t s1 = Power_RtcEdge();
+    uint32_t c1 = Timebase_Now();
+    power_tick_q16 = (uint32_t)(((uint64_t)(c1 - c0) << 16) / ((s0 - s1) & POWER_RTC_SS_MASK));
+
+    // PA3保持串口复用功能，STOP期间另开EXTI线3的下降沿（起始位）唤醒
+    SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI3;
+    EXTI->FTSR |= EXTI_FTSR_TR3;
+    HAL_NVIC_SetPriority(EXTI3_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(EXTI3_IRQn);
+
+    HAL_PWREx_EnableFlashPowerDown();  // STOP时Flash也断电，唤醒多约几十微秒
+#endif
+#ifdef DEBUG
+    HAL_DBGMCU_EnableDBGSleepMode();
+    HAL_DBGMCU_EnableDBGStopMode();
+#endif
+}
+
+void Power_Wake(void) {
+    power_wake = 1;
+}
+
+static uint32_t Power_SuspendTick(void) {
+    HAL_SuspendTick();
+    return Timebase_Now();
+}
+
+// 按TIM2补上SysTick停掉期间的毫秒数
+static void Power_ResumeTick(uint32_t since) {
+    power_tick_rem += Timebase_Elapsed(since);
+    uwTick += power_tick_rem / 1000U;
+    power_tick_rem %= 1000U;
+    HAL_ResumeTick();
+}
+
+// 以下均在关中断时调用：等待期间到达的中断仍会唤醒，待恢复时钟、返回后才执行
+static void Power_EnterSleep(void) {
+    uint32_t since = Power_SuspendTick();
+    HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    Power_ResumeTick(since);
+}
+
+static void Power_SleepUntil(uint32_t deadline) {
+    __HAL_TIM_SET_COMPARE(power_htim, TIM_CHANNEL_1, deadline);
+    __HAL_TIM_CLEAR_IT(power_htim, TIM_IT_CC1);
+    __HAL_TIM_ENABLE_IT(power_htim, TIM_IT_CC1);
+    // 比较只在计数器经过该值时触发，设置前已错过的不再等待
+    if (!Timebase_Reached(deadline)) {
+        Power_EnterSleep();
+    }
+    __HAL_TIM_DISABLE_IT(power_htim, TIM_IT_CC1);
+}
+
+#if POWER_USE_STOP
+static void Power_Stop(uint32_t us) {
+    if (us > POWER_STOP_MAX_US) {
+        us = POWER_STOP_MAX_US;
+    }
+    uint32_t wakeup = Power_UsToTicks(us) / 2U;  // 唤醒定时器的计数是子秒计数的一半
+    if (wakeup < 2U) {
+        return;
+    }
+
+    uint32_t since = Power_SuspendTick();
+    uint32_t s0 = Power_RtcEdge();
+    uint32_t c0 = Timebase_Now();
+    Power_RtcWakeupIn(wakeup);
+    EXTI->PR = EXTI_PR_PR3;
+    EXTI->IMR |= EXTI_IMR_MR3;
+
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+    Power_RestoreClock();
+    EXTI->IMR &= ~EXTI_IMR_MR3;
+    Power_RtcWakeupStop();
+    // TIM2在STOP期间停走，按RTC测得的时间接上，信标间隔不因休眠而变
+    uint32_t s1 = Power_RtcEdge();
+    __HAL_TIM_SET_COUNTER(power_htim, c0 + Power_TicksToUs((s0 - s1) & POWER_RTC_SS_MASK));
+    Power_ResumeTick(since);
+}
+#endif
+
+void Power_Sleep(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!power_wake) {
+        Power_EnterSleep();
+    }
+    power_wake = 0;
+    __set_PRIMASK(primask);
+}
+
+void Power_Wait(uint32_t deadline, uint8_t allow_stop) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!power_wake) {
+#if POWER_USE_STOP
+        int32_t remain = (int32_t)(deadline - Timebase_Now());
+        if (allow_stop && remain >= POWER_STOP_MIN_US) {
+            Power_Stop((uint32_t)remain - POWER_STOP_WAKE_US);
+        } else {
+            Power_SleepUntil(deadline);
+        }
+#else
+        Power_SleepUntil(deadline);
+#endif
+    }
+    power_wake = 0;
+    __set_PRIMASK(primask);
+}
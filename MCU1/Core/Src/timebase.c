@@ -0,0 +1,7 @@
+#include "main.h"
+#include "timebase.h"
+
+// TIM2由 MX_TIM2_Init 配置为1MHz、32位自由运行，main里启动后一直计数
+uint32_t Timebase_Now(void) {
+    return TIM2->CNT;
+}
@@ -0,0 +1,134 @@
+#include "tone.h"
+#include <math.h>
+#include <string.h>
+
+#define TONE_PI 3.14159265f
+#define TONE_CYCLE_US (1000000U / MORSE_TONE_HZ)
+
+static TIM_HandleTypeDef *tone_htim;
+// 预先算好的整周期波形，播放时只按周期拷贝，不逐点计算
+static uint16_t tone_sine[TONE_SAMPLES_PER_CYCLE];
+static uint16_t tone_silence[TONE_SAMPLES_PER_CYCLE];
+static uint16_t tone_rise[TONE_RAMP_CYCLES][TONE_SAMPLES_PER_CYCLE]; // 第k行包络从k/R升到(k+1)/R
+static uint16_t tone_fall[TONE_RAMP_CYCLES][TONE_SAMPLES_PER_CYCLE]; // 第k行包络从(k+1)/R降到k/R
+static uint16_t tone_buf[TONE_BUF_CYCLES][TONE_SAMPLES_PER_CYCLE];
+
+static ToneRunSource tone_next;
+static void (*tone_done)(void);
+static uint32_t tone_run_cycles = 0;  // 当前段剩余的载波周期数
+static uint8_t tone_level = 0;
+static uint8_t tone_env = 0;          // 当前包络级数，0为静音，TONE_RAMP_CYCLES为满幅
+static uint8_t tone_idle_halves = 0;  // 连续填充的全静音半缓冲数
+
+// 升余弦包络，x从0到1
+static float Tone_Envelope(float x) {
+    return 0.5f - 0.5f * cosf(TONE_PI * x);
+}
+
+static uint16_t Tone_Sample(float v) {
+    return (uint16_t)(TONE_MIDSCALE + v * TONE_AMPLITUDE + 0.5f);
+}
+
+void Tone_Init(TIM_HandleTypeDef *htim) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    tone_htim = htim;
+    for (uint16_t j = 0; j < TONE_SAMPLES_PER_CYCLE; j++) {
+        float phase = (float)j / TONE_SAMPLES_PER_CYCLE;
+        float s = sinf(2.0f * TONE_PI * phase);
+        tone_sine[j] = Tone_Sample(s);
+        tone_silence[j] = TONE_MIDSCALE;
+        for (uint8_t k = 0; k < TONE_RAMP_CYCLES; k++) {
+            tone_rise[k][j] = Tone_Sample(s * Tone_Envelope((k + phase) / TONE_RAMP_CYCLES));
+            tone_fall[k][j] = Tone_Sample(s * Tone_Envelope((k + 1 - phase) / TONE_RAMP_CYCLES));
+        }
+    }
+
+    // 工程中没有HAL DAC驱动，直接操作寄存器：不用触发，写DHR后一个APB1周期即更新输出
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_DAC_CLK_ENABLE();
+    GPIO_InitStruct.Pin = GPIO_PIN_4;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    DAC->DHR12R1 = TONE_MIDSCALE;
+    DAC->CR = DAC_CR_EN1;
+}
+
+// 把游程展开成整周期波形，返回本次是否填入了任何待播放内容
+static uint8_t Tone_Fill(uint16_t (*buf)[TONE_SAMPLES_PER_CYCLE], uint16_t cycles) {
+    uint8_t active = 0;
+
+    for (uint16_t c = 0; c < cycles; c++) {
+        while (tone_run_cycles == 0) {
+            uint32_t us;
+            int8_t level = tone_next(&us);
+            if (level < 0) {
+                tone_level = 0;
+                break;
+            }
+            tone_level = level;
+            tone_run_cycles = (us + TONE_CYCLE_US / 2) / TONE_CYCLE_US;
+        }
+        if (tone_run_cycles != 0) {
+            tone_run_cycles--;
+            active = 1;
+        }
+
+        // 下降沿从松键时刻开始占用间隔，包络中点与按键边沿相差半个渐变时间，点划长度不变
+        const uint16_t *src;
+        if (tone_level) {
+            src = tone_env < TONE_RAMP_CYCLES ? tone_rise[tone_env++] : tone_sine;
+        } else if (tone_env > 0) {
+            src = tone_fall[--tone_env];
+            active = 1;
+        } else {
+            src = tone_silence;
+        }
+        memcpy(buf[c], src, sizeof(tone_sine));
+    }
+    return active;
+}
+
+static void Tone_Refill(uint16_t (*buf)[TONE_SAMPLES_PER_CYCLE]) {
+    if (Tone_Fill(buf, TONE_BUF_CYCLES / 2)) {
+        tone_idle_halves = 0;
+    } else if (++tone_idle_halves >= 2) {
+        // 两个半缓冲都只剩静音，消息已播放完毕
+        __HAL_TIM_DISABLE_DMA(tone_htim, TIM_DMA_UPDATE);
+        HAL_TIM_Base_Stop(tone_htim);
+        HAL_DMA_Abort_IT(tone_htim->hdma[TIM_DMA_ID_UPDATE]);
+        DAC->DHR12R1 = TONE_MIDSCALE;
+        tone_done();
+    }
+}
+
+void Tone_DMA_HalfCplt(DMA_HandleTypeDef *hdma) {
+    Tone_Refill(&tone_buf[0]);
+}
+
+void Tone_DMA_Cplt(DMA_HandleTypeDef *hdma) {
+    Tone_Refill(&tone_buf[TONE_BUF_CYCLES / 2]);
+}
+
+uint8_t Tone_Start(ToneRunSource next, void (*done)(void)) {
+    tone_next = next;
+    tone_done = done;
+    tone_run_cycles = 0;
+    tone_level = 0;
+    tone_env = 0;
+    tone_idle_halves = 0;
+    if (!Tone_Fill(tone_buf, TONE_BUF_CYCLES)) {
+        return 0;
+    }
+
+    DMA_HandleTypeDef *hdma = tone_htim->hdma[TIM_DMA_ID_UPDATE];
+    hdma->XferHalfCpltCallback = Tone_DMA_HalfCplt;
+    hdma->XferCpltCallback = Tone_DMA_Cplt;
+    HAL_DMA_Start_IT(hdma, (uint32_t)tone_buf, (uint32_t)&DAC->DHR12R1,
+                     TONE_BUF_CYCLES * TONE_SAMPLES_PER_CYCLE);
+    __HAL_TIM_SET_COUNTER(tone_htim, 0);
+    __HAL_TIM_ENABLE_DMA(tone_htim, TIM_DMA_UPDATE);
+    HAL_TIM_Base_Start(tone_htim);
+    return 1;
+}
@@ -0,0 +1,77 @@
+#include "uart_rx.h"
+#include "ring_buffer.h"
+
+static UART_HandleTypeDef *uart_rx_huart;
+static uint8_t uart_rx_buf[UART_RX_BUF_SIZE];  // DMA写入
+static Ring uart_rx_ring;                      // 接收事件时放出，主循环取走
+static volatile uint8_t uart_rx_restart = 0;   // 出错后由主循环重新开始接收
+static volatile uint8_t uart_rx_overrun = 0;   // DMA追上了未读数据，由主循环丢弃积压
+static volatile uint32_t uart_rx_dropped = 0;  // 因溢出或出错丢弃的字节数，只由主循环写
+// 以下两项只在接收事件里使用：DMA累计写入的字节数 = 本圈起点 + pos
+static uint16_t uart_rx_lap;                   // 当前这一圈起点处的累计字节数
+static uint16_t uart_rx_total;                 // 已放出的累计字节数
+
+// 只在DMA未运行时调用（初始化或主循环里中止接收之后），此时没有生产者，可以同时重置head和tail
+static void UartRx_Start(void) {
+    if (!Ring_Init(&uart_rx_ring, UART_RX_BUF_SIZE)) {
+        Error_Handler();
+    }
+    uart_rx_lap = 0;
+    uart_rx_total = 0;
+    uart_rx_overrun = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(uart_rx_huart, uart_rx_buf, UART_RX_BUF_SIZE);
+}
+
+void UartRx_Init(UART_HandleTypeDef *huart) {
+    uart_rx_huart = huart;
+    UartRx_Start();
+}
+
+uint16_t UartRx_Peek(const uint8_t **data) {
+    if (uart_rx_restart) {
+        uart_rx_restart = 0;
+        HAL_UART_AbortReceive(uart_rx_huart);
+        uart_rx_dropped += Ring_Count(&uart_rx_ring);
+        UartRx_Start();
+    }
+    if (uart_rx_overrun) {
+        // 积压里最早的部分已被覆盖，无法分辨从哪里开始有效，全部丢弃，从DMA当前位置接着读
+        uart_rx_overrun = 0;
+        uint16_t stale = Ring_Count(&uart_rx_ring);
+        uart_rx_dropped += stale;
+        Ring_Consume(&uart_rx_ring, stale);
+    }
+    *data = &uart_rx_buf[Ring_Tail(&uart_rx_ring)];
+    // 数据回绕时先返回到缓冲末尾的部分
+    return Ring_Contiguous(&uart_rx_ring);
+}
+
+void UartRx_Consume(uint16_t len) {
+    Ring_Consume(&uart_rx_ring, len);
+}
+
+uint32_t UartRx_Dropped(void) {
+    return uart_rx_dropped;
+}
+
+void UartRx_Event(uint16_t pos) {
+    // 全满事件时pos等于缓冲长度，DMA回到起点，记一圈。按累计字节数而不是按缓冲下标求差，
+    // 主循环积压超过一圈时才不会被掩码成一个小数
+    if (HAL_UARTEx_GetRxEventType(uart_rx_huart) == HAL_UART_RXEVENT_TC) {
+        uart_rx_lap += UART_RX_BUF_SIZE;
+        pos = 0;
+    }
+    uint16_t n = (uint16_t)(uart_rx_lap + pos - uart_rx_total);
+    if (n > Ring_Free(&uart_rx_ring)) {
+        // 未读数据已被覆盖。照常放出（Ring_Contiguous 不会越过缓冲末尾），由主循环把tail追到head
+        uart_rx_overrun = 1;
+    }
+    uart_rx_total += n;
+    Ring_Publish(&uart_rx_ring, n);
+}
+
+void UartRx_Error(void) {
+    // 溢出、噪声等错误会中止DMA接收，未读数据作废后重新开始。tail只能由主循环写，
+    // 中断里只做标记，由下一次 UartRx_Peek 中止并重启接收
+    uart_rx_restart = 1;
+}
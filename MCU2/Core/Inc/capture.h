@@ -0,0 +1,21 @@
+#ifndef _CAPTURE_H_
+#define _CAPTURE_H_
+#include "main.h"
+
+// PA0 (TIM2_CH1) 双边沿输入捕获，DMA循环写入时间戳环形缓冲
+// 环形缓冲长度（必须是2的幂），即主循环来不及处理时最多可积压的边沿数
+#define CAPTURE_RING_SIZE 64
+
+void Capture_Init(TIM_HandleTypeDef *htim);            // 启动捕获，TIM2需已配置为1MHz计数，时间戳与 Timebase_Now 同一时基
+uint8_t Capture_Read(uint32_t *timestamp, uint8_t *level); // 取出一个边沿：时间戳（微秒）及边沿后的电平，无数据返回0
+uint8_t Capture_Level(void);                            // 已取出的最后一个边沿之后的电平
+uint8_t Capture_Resync(void);                           // 丢弃未取出的边沿，按PA0当前电平重新定起点并返回该电平；
+                                                        // 用于STOP唤醒后，此时TIM2停走期间的边沿没有被捕获
+
+// 间隔超时：TIM2的CH3/CH4输出比较在字母间隔和单词间隔到点时各产生一次事件，
+// 布置之后若又捕获到新边沿，事件作废
+void Capture_ArmGap(uint32_t char_deadline, uint32_t word_deadline); // 在处理完下降沿后调用，参数为绝对时间（微秒）
+uint8_t Capture_GapEvent(void);                         // 有到点的间隔事件时返回1并清除
+void Capture_GapElapsed(TIM_HandleTypeDef *htim);       // 在TIM2输出比较回调里调用
+
+#endif
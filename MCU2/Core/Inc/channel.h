@@ -0,0 +1,45 @@
+#ifndef _CHANNEL_H_
+#define _CHANNEL_H_
+#include "main.h"
+#include "goertzel.h"
+#include "detector.h"
+#include "morse_decoder.h"
+
+// 频分复用接收：模拟通道的每块采样同时送入每路的Goertzel滤波器，每路一个独立的解码器和速度估计，
+// 房间里的多个发送端各用一个蜂鸣器频率，一块接收板即可同时解码
+#define RX_CHANNELS 4
+// 各路检测频率（Hz），都在DFT频点上，相邻至少隔4个频点，第2路即默认的 MORSE_TONE_HZ；
+// 方波蜂鸣器的各奇次谐波（含16kHz采样后的混叠，到39次为止）都不落在其他路的±1个频点内
+#define RX_CHANNEL_FREQS {1000, 1500, 2000, 2750}
+#define TONE_POWER_ON (100.0f * 100.0f)  // MFSK：音调幅度超过100个ADC计数才参与判决
+#define RX_MIN_AMPLITUDE 30.0f           // 自适应开门限的下限（ADC计数），安静房间里不会被ADC噪声触发
+#define RX_DWELL_BLOCKS 2                // 按键/间隔至少持续2块（16ms）才确认，两个边沿延迟相同，时长不变
+
+typedef struct {
+    Goertzel tone;
+    Detector detector;      // 本路的噪声底、峰值跟踪和迟滞判决
+    MorseDecoder decoder;   // 解码状态及速度估计
+    float power;            // 最近一块在本路频率上的幅度平方
+    uint32_t last_end;      // 上一个点划的结束时间
+    uint32_t mark_start;    // 当前按键的开始时间
+    uint8_t level;          // 当前是否处于按键状态
+    char tag;               // 输出前缀中的通道号，0表示不加前缀（单路接收）
+} RxChannel;
+
+typedef uint16_t (*ChannelWrite)(const uint8_t *data, uint16_t len);  // 解码输出，返回实际写入的字节数
+
+// 多路同时输出时会交错，提前输出的退格无法只撤回本路，多路接收应关闭early
+void Channel_Init(RxChannel *ch, char tag, float freq_hz, const MorseTiming *t, uint8_t early);
+void Channel_SetOutput(ChannelWrite write);                    // 各路解码出的字符写到哪里，默认 UartTx_Write
+void Channel_Flush(RxChannel *ch, uint32_t gap_us);            // 输出间隔已持续gap_us时解码出的字母和单词间隔
+void Channel_Edge(RxChannel *ch, uint32_t timestamp, uint8_t level); // 处理一次按键状态变化，时间单位为微秒
+void Channel_Idle(RxChannel *ch, uint32_t now);                // 线路空闲时按当前门限输出已完成的字母和单词间隔
+void Channel_Reset(RxChannel *ch, uint32_t now, uint8_t level); // 丢失边沿后重新定起点：放弃当前字符，按now时的电平继续
+float Channel_Power(RxChannel *ch, const uint16_t *block);     // 只求一块在本路频率上的能量
+uint8_t Channel_Detect(RxChannel *ch, const uint16_t *block);  // 求能量并做门限判决，不送解码器；返回该块是否为按键
+// 按一块的判决解码：状态变化处即为边沿，时间取该块结束时刻now
+void Channel_Level(RxChannel *ch, uint8_t level, uint32_t now);
+// 模拟通道的块处理：Channel_Detect 后 Channel_Level；返回该块是否为按键
+uint8_t Channel_Block(RxChannel *ch, const uint16_t *block, uint32_t now);
+
+#endif
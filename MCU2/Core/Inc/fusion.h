@@ -0,0 +1,47 @@
+#ifndef _FUSION_H_
+#define _FUSION_H_
+#include <stdint.h>
+
+// 数字/模拟融合：边沿时间取PA0比较器捕获（1us分辨率），是否真有按键由PA1的音调能量判决确认。
+// 数字脉冲要等模拟判决覆盖到它结束之后才放行：与模拟按键重叠的保留，不重叠的视为毛刺丢弃；
+// 模拟判为按键而比较器在门限附近漏掉的，按模拟判决的时间补一个脉冲（块分辨率）
+#define FUSION_MAX_PULSES 8    // 等待确认的脉冲数
+#define FUSION_OUT_LEN 16      // 已确认、待读取的边沿数（必须是2的幂）
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+    uint8_t confirmed;  // 已与模拟按键重叠
+} FusionPulse;
+
+typedef struct {
+    FusionPulse pulses[FUSION_MAX_PULSES];  // 按开始时间排序
+    uint8_t count;
+    uint32_t delay_us;      // 模拟判决相对实际边沿的延迟
+    uint32_t tol_us;        // 判断重叠时两侧放宽的时间
+    uint32_t digital_start; // 数字通道当前按键的开始时间
+    uint8_t digital_level;
+    uint32_t analog_start;  // 模拟通道当前（或上一个）按键的开始时间，已扣除延迟
+    uint32_t analog_end;    // 模拟通道上一个按键的结束时间
+    uint8_t analog_level;
+    uint8_t analog_matched; // 当前模拟按键已确认过数字脉冲（含已放出的），结束时不再补
+    uint32_t analog_time;   // 模拟判决已覆盖到的时刻
+    uint32_t out_ts[FUSION_OUT_LEN];
+    uint8_t out_level[FUSION_OUT_LEN];
+    uint8_t out_head;
+    uint8_t out_tail;
+    uint32_t emitted;       // 最后放出的边沿时间，之后放出的都不早于它
+    uint32_t late;          // 到达时已早于 Fusion_Settled 而丢弃的数字脉冲数
+} Fusion;
+
+void Fusion_Init(Fusion *f, uint32_t delay_us, uint32_t tol_us, uint32_t now);  // now：模拟通道开始采样的时刻
+// 输入一个（已去抖的）数字边沿。开始于 Fusion_Settled 之前的脉冲来得太晚（解码器已按此前无边沿处理），
+// 若再放出会与已放出的边沿顺序颠倒，整个脉冲丢弃并计入late
+void Fusion_Digital(Fusion *f, uint32_t ts, uint8_t level);
+void Fusion_Resync(Fusion *f, uint32_t ts, uint8_t level);   // 丢失数字边沿后按ts时的电平重新定起点，进行中的数字脉冲作废
+void Fusion_Analog(Fusion *f, uint32_t ts, uint8_t level);   // 输入一块的模拟判决，ts为该块结束时刻（与捕获同一时基）
+uint8_t Fusion_Read(Fusion *f, uint32_t *ts, uint8_t *level); // 按时间顺序取出一个已确认的边沿，没有返回0
+uint32_t Fusion_Settled(Fusion *f);  // 此时刻之前的边沿都已放出，线路空闲判断只能用到这里
+uint8_t Fusion_Idle(const Fusion *f); // 没有待确认或待读取的脉冲，两路也都不在按键中
+
+#endif
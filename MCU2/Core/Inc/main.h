@@ -73,7 +73,18 @@ void Error_Handler(void);
 #define SWO_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
-
+// 1: 接收端按FreeRTOS任务运行（捕获、DSP、解码、输出四个任务，见 main.c），HAL时基改用TIM7。
+//    选 Debug_FreeRTOS 构建配置即定义 USE_FREERTOS=1 并编译 Middlewares。该配置尚未在硬件上验证。
+//    内核按CubeMX的目录放入 Middlewares/Third_Party/FreeRTOS/Source：tasks.c、queue.c、list.c、include/，
+//    portable 下只保留 GCC/ARM_CM4F 与 MemMang/heap_4.c（Middlewares 整个目录都会参与编译）
+#ifndef USE_FREERTOS
+#define USE_FREERTOS 0
+#endif
+#if USE_FREERTOS && defined(__has_include)
+#if !__has_include("FreeRTOS.h")
+#error "USE_FREERTOS=1 needs the FreeRTOS kernel in Middlewares/Third_Party/FreeRTOS/Source"
+#endif
+#endif
 /* USER CODE END Private defines */
 
 #ifdef __cplusplus
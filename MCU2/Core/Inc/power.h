@@ -0,0 +1,16 @@
+#ifndef _POWER_H_
+#define _POWER_H_
+#include "main.h"
+
+// 线路长时间空闲时进入STOP，由PA0（比较器数字输出，TIM2_CH1）的上升沿经EXTI线0唤醒。
+// 不用STANDBY：STANDBY唤醒等于复位，RAM中的解码器状态和速度估计全部丢失，复位后要几毫秒才能重新捕获。
+// STOP保留RAM和外设配置，TIM2/TIM3随时钟一起停走、一起恢复，捕获与采样块之间的时间对应关系不变；
+// 唤醒时第一个上升沿已经过去，由调用者按测得的唤醒延迟补上
+#define POWER_STOP_WAKE_US 14  // STOP本身的唤醒时间（主调压器、Flash不断电，数据手册典型值），DWT测不到这一段
+
+void Power_Init(void);
+// 进入STOP直到PA0上升沿。由PA0唤醒时返回1：wake_us为从边沿到时钟恢复（TIM2重新按1MHz计数）的实际微秒数，
+// tim_us为这段时间里TIM2走过的计数，倒推边沿的时间戳要用它。PA0已为高电平，或由其他中断唤醒时返回0
+uint8_t Power_StopUntilEdge(uint32_t *wake_us, uint32_t *tim_us);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _SAMPLER_H_
+#define _SAMPLER_H_
+#include "main.h"
+
+// PA1 (ADC1_IN1) 由TIM3 TRGO定时触发采样，DMA循环写入乒乓缓冲
+// 采样率（Hz）与每块采样点数，块长即处理周期：128 / 16kHz = 8ms
+#define SAMPLER_RATE_HZ 16000
+#define SAMPLER_BLOCK_LEN 128
+#define SAMPLER_BLOCK_US (SAMPLER_BLOCK_LEN * 1000000U / SAMPLER_RATE_HZ)
+
+void Sampler_Init(ADC_HandleTypeDef *hadc, TIM_HandleTypeDef *htim); // 启动DMA和触发定时器
+const uint16_t *Sampler_GetBlock(uint32_t *seq); // 取出一个已采满的块及其序号（自启动起第几块），无新块返回NULL，需在下一块采满前处理完
+uint32_t Sampler_Overruns(void);          // 因主循环来不及处理而被覆盖的块数
+void Sampler_HalfCplt(void);              // 在ADC半传输回调里调用：前半缓冲已采满
+void Sampler_Cplt(void);                  // 在ADC传输完成回调里调用：后半缓冲已采满
+
+#endif
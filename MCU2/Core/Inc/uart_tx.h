@@ -0,0 +1,14 @@
+#ifndef _UART_TX_H_
+#define _UART_TX_H_
+#include "main.h"
+
+// USART2 发送环形缓冲：写入立即返回，由DMA在后台成段发出
+// 缓冲长度（必须是2的幂），写满后多出的字节被丢弃
+#define UART_TX_RING_SIZE 256
+
+void UartTx_Init(UART_HandleTypeDef *huart);
+uint16_t UartTx_Write(const uint8_t *data, uint16_t len); // 返回实际写入缓冲的字节数，不阻塞
+uint8_t UartTx_Idle(void);                                // 缓冲中的数据已全部发出
+void UartTx_Cplt(void);                                   // 在USART2发送完成回调里调用
+
+#endif
@@ -0,0 +1,80 @@
+#include "capture.h"
+#include "timebase.h"
+
+static TIM_HandleTypeDef *capture_htim;
+static uint32_t capture_ring[CAPTURE_RING_SIZE];  // DMA写入
+static uint16_t capture_tail = 0;                 // 下一个待读取的位置
+static uint8_t capture_level = 0;                 // 最后读取的边沿之后的电平
+static volatile uint16_t capture_gap_head = 0;    // 布置间隔超时时DMA的写入位置
+static volatile uint8_t capture_gap_event = 0;
+
+// DMA剩余计数换算成写入位置
+static uint16_t Capture_Head(void) {
+    return (uint16_t)(CAPTURE_RING_SIZE - __HAL_DMA_GET_COUNTER(capture_htim->hdma[TIM_DMA_ID_CC1]))
+         & (CAPTURE_RING_SIZE - 1);
+}
+
+void Capture_Init(TIM_HandleTypeDef *htim) {
+    capture_htim = htim;
+    capture_tail = 0;
+    // 双边沿捕获本身不带极性信息，以启动时的电平为起点逐个边沿翻转
+    capture_level = (uint8_t)HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0);
+    HAL_TIM_IC_Start_DMA(htim, TIM_CHANNEL_1, capture_ring, CAPTURE_RING_SIZE);
+}
+
+uint8_t Capture_Read(uint32_t *timestamp, uint8_t *level) {
+    if (capture_tail == Capture_Head()) {
+        return 0;
+    }
+    *timestamp = capture_ring[capture_tail];
+    capture_tail = (capture_tail + 1) & (CAPTURE_RING_SIZE - 1);
+    capture_level ^= 1;
+    *level = capture_level;
+    return 1;
+}
+
+uint8_t Capture_Level(void) {
+    return capture_level;
+}
+
+uint8_t Capture_Resync(void) {
+    uint16_t head;
+
+    // 读电平前后DMA位置不变，才能确认这一电平之后没有已捕获而未丢弃的边沿
+    do {
+        head = Capture_Head();
+        capture_level = (uint8_t)HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0);
+    } while (head != Capture_Head());
+    capture_tail = head;
+    return capture_level;
+}
+
+void Capture_ArmGap(uint32_t char_deadline, uint32_t word_deadline) {
+    capture_gap_head = Capture_Head();
+    __HAL_TIM_SET_COMPARE(capture_htim, TIM_CHANNEL_3, char_deadline);
+    __HAL_TIM_SET_COMPARE(capture_htim, TIM_CHANNEL_4, word_deadline);
+    __HAL_TIM_CLEAR_IT(capture_htim, TIM_IT_CC3 | TIM_IT_CC4);
+    __HAL_TIM_ENABLE_IT(capture_htim, TIM_IT_CC3 | TIM_IT_CC4);
+
+    // 比较只在计数器经过该值时触发，主循环处理边沿时若已错过，直接记为到点
+    if (Timebase_Reached(char_deadline)) {
+        capture_gap_event = 1;
+    }
+}
+
+uint8_t Capture_GapEvent(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t event = capture_gap_event;
+    capture_gap_event = 0;
+    __set_PRIMASK(primask);
+    return event;
+}
+
+void Capture_GapElapsed(TIM_HandleTypeDef *htim) {
+    // 每个比较只用一次，否则计数器回绕后会再次触发
+    __HAL_TIM_DISABLE_IT(htim, htim->Channel == HAL_TIM_ACTIVE_CHANNEL_3 ? TIM_IT_CC3 : TIM_IT_CC4);
+    if (Capture_Head() == capture_gap_head) {
+        capture_gap_event = 1;  // 布置之后没有新边沿，间隔确实持续到了这一时刻
+    }
+}
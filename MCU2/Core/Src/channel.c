@@ -0,0 +1,89 @@
+#include "channel.h"
+#include "sampler.h"
+#include "uart_tx.h"
+#include <math.h>
+
+static char channel_last_tag = 0;  // 上一个输出字符所属的通道
+static ChannelWrite channel_write = UartTx_Write;
+
+void Channel_SetOutput(ChannelWrite write) {
+    channel_write = write;
+}
+
+// 与上一个字符不是同一路时，先换行并输出 "通道号:"
+static void Channel_Output(RxChannel *ch, char c) {
+    if (ch->tag != 0 && ch->tag != channel_last_tag) {
+        uint8_t prefix[4] = {'\r', '\n', (uint8_t)ch->tag, ':'};
+        channel_write(prefix, sizeof(prefix));
+        channel_last_tag = ch->tag;
+    }
+    channel_write((uint8_t*)&c, 1);
+}
+
+void Channel_Init(RxChannel *ch, char tag, float freq_hz, const MorseTiming *t, uint8_t early) {
+    Goertzel_Init(&ch->tone, freq_hz, SAMPLER_RATE_HZ, SAMPLER_BLOCK_LEN);
+    Detector_Init(&ch->detector, RX_MIN_AMPLITUDE, RX_DWELL_BLOCKS);
+    MorseDecoder_Init(&ch->decoder, t, early);
+    ch->power = 0;
+    ch->last_end = 0;
+    ch->mark_start = 0;
+    ch->level = 0;
+    ch->tag = tag;
+}
+
+void Channel_Flush(RxChannel *ch, uint32_t gap_us) {
+    char letter;
+    while ((letter = MorseDecoder_Poll(&ch->decoder, gap_us)) != '\0') {
+        Channel_Output(ch, letter);
+    }
+}
+
+void Channel_Edge(RxChannel *ch, uint32_t timestamp, uint8_t level) {
+    ch->level = level;
+    if (level) {
+        // 上升沿：间隔结束，若已超过字母间隔则先输出上一个字符
+        uint32_t gap = timestamp - ch->last_end;
+        Channel_Flush(ch, gap);
+        MorseDecoder_Space(&ch->decoder, gap);
+        ch->mark_start = timestamp;
+    } else if (MorseDecoder_Mark(&ch->decoder, timestamp - ch->mark_start)) {
+        ch->last_end = timestamp;
+        Channel_Flush(ch, 0);  // 提前输出已确定的字符，或结束超出码表的点划
+    }
+}
+
+void Channel_Idle(RxChannel *ch, uint32_t now) {
+    if (ch->level == 0) {
+        Channel_Flush(ch, now - ch->last_end);
+    }
+}
+
+void Channel_Reset(RxChannel *ch, uint32_t now, uint8_t level) {
+    MorseDecoder_Abort(&ch->decoder);
+    ch->level = level;
+    ch->last_end = now;
+    ch->mark_start = now;
+}
+
+float Channel_Power(RxChannel *ch, const uint16_t *block) {
+    ch->power = Goertzel_Power(&ch->tone, block);
+    return ch->power;
+}
+
+uint8_t Channel_Detect(RxChannel *ch, const uint16_t *block) {
+    return Detector_Update(&ch->detector, sqrtf(Channel_Power(ch, block)));
+}
+
+void Channel_Level(RxChannel *ch, uint8_t level, uint32_t now) {
+    if (level != ch->level) {
+        Channel_Edge(ch, now, level);
+    }
+    Channel_Idle(ch, now);
+}
+
+uint8_t Channel_Block(RxChannel *ch, const uint16_t *block, uint32_t now) {
+    uint8_t level = Channel_Detect(ch, block);
+
+    Channel_Level(ch, level, now);
+    return level;
+}
@@ -0,0 +1,177 @@
+#include "fusion.h"
+
+#define FUSION_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)  // a早于b，计数器回绕后仍成立
+
+void Fusion_Init(Fusion *f, uint32_t delay_us, uint32_t tol_us, uint32_t now) {
+    f->count = 0;
+    f->delay_us = delay_us;
+    f->tol_us = tol_us;
+    f->digital_start = 0;
+    f->digital_level = 0;
+    f->analog_start = 0;
+    f->analog_end = 0;
+    f->analog_level = 0;
+    f->analog_matched = 0;
+    f->analog_time = now;
+    f->out_head = 0;
+    f->out_tail = 0;
+    f->emitted = now;
+    f->late = 0;
+}
+
+static void Fusion_Emit(Fusion *f, uint32_t ts, uint8_t level) {
+    if ((uint8_t)(f->out_head - f->out_tail) >= FUSION_OUT_LEN) {
+        return;  // 主循环来不及读取，丢弃
+    }
+    f->out_ts[f->out_head & (FUSION_OUT_LEN - 1)] = ts;
+    f->out_level[f->out_head & (FUSION_OUT_LEN - 1)] = level;
+    f->out_head++;
+    f->emitted = ts;
+}
+
+// 放行或丢弃最早的一个脉冲；与已放出的脉冲重叠的部分截掉，放出的边沿始终按时间顺序
+static void Fusion_Pop(Fusion *f) {
+    uint32_t start = f->pulses[0].start;
+
+    if (FUSION_BEFORE(start, f->emitted)) {
+        start = f->emitted;
+    }
+    if (f->pulses[0].confirmed && FUSION_BEFORE(start, f->pulses[0].end)) {
+        Fusion_Emit(f, start, 1);
+        Fusion_Emit(f, f->pulses[0].end, 0);
+    }
+    f->count--;
+    for (uint8_t i = 0; i < f->count; i++) {
+        f->pulses[i] = f->pulses[i + 1];
+    }
+}
+
+// 按开始时间插入一个脉冲，队列满时先处理最早的
+static void Fusion_Insert(Fusion *f, uint32_t start, uint32_t end, uint8_t confirmed) {
+    if (f->count >= FUSION_MAX_PULSES) {
+        Fusion_Pop(f);
+    }
+    uint8_t i = f->count;
+    while (i > 0 && FUSION_BEFORE(start, f->pulses[i - 1].start)) {
+        f->pulses[i] = f->pulses[i - 1];
+        i--;
+    }
+    f->pulses[i].start = start;
+    f->pulses[i].end = end;
+    f->pulses[i].confirmed = confirmed;
+    f->count++;
+}
+
+// [start, end] 是否与模拟按键 [a_start, a_end]（两侧各放宽tol）重叠
+static uint8_t Fusion_Overlap(Fusion *f, uint32_t start, uint32_t end, uint32_t a_start, uint32_t a_end) {
+    return !FUSION_BEFORE(end, a_start - f->tol_us) && !FUSION_BEFORE(a_end + f->tol_us, start);
+}
+
+void Fusion_Digital(Fusion *f, uint32_t ts, uint8_t level) {
+    if (level) {
+        if (FUSION_BEFORE(ts, Fusion_Settled(f))) {
+            f->late++;
+            f->digital_level = 0;  // 随后的下降沿也不再处理
+            return;
+        }
+        f->digital_start = ts;
+        f->digital_level = 1;
+        return;
+    }
+    if (!f->digital_level) {
+        return;
+    }
+    f->digital_level = 0;
+    // 模拟判决较晚，此时能确认的只有正在进行或刚结束的模拟按键，其余留到模拟判决跟上后再定
+    uint8_t confirmed = f->analog_level
+        ? !FUSION_BEFORE(ts, f->analog_start - f->tol_us)
+        : Fusion_Overlap(f, f->digital_start, ts, f->analog_start, f->analog_end);
+    if (confirmed && f->analog_level) {
+        f->analog_matched = 1;
+    }
+    Fusion_Insert(f, f->digital_start, ts, confirmed);
+}
+
+void Fusion_Resync(Fusion *f, uint32_t ts, uint8_t level) {
+    // 比较器漏掉的部分仍可由模拟判决补上；新起点不早于已放出的时刻
+    f->digital_level = 0;
+    uint32_t settled = Fusion_Settled(f);
+    f->digital_start = FUSION_BEFORE(ts, settled) ? settled : ts;
+    f->digital_level = level;
+}
+
+void Fusion_Analog(Fusion *f, uint32_t ts, uint8_t level) {
+    uint32_t t = ts - f->delay_us;  // 换算成按键实际开始/结束的大致时刻
+    uint8_t i;
+
+    if (level && !f->analog_level) {
+        f->analog_level = 1;
+        f->analog_start = t;
+        f->analog_matched = 0;
+        for (i = 0; i < f->count; i++) {
+            if (!FUSION_BEFORE(f->pulses[i].end, t - f->tol_us)) {
+                f->pulses[i].confirmed = 1;
+                f->analog_matched = 1;
+            }
+        }
+    } else if (!level && f->analog_level) {
+        f->analog_level = 0;
+        f->analog_end = t;
+        // 按键中途已确认并放出的数字脉冲也算：比较器只覆盖了按键的开头时，不再把整个按键补一遍
+        uint8_t matched = f->analog_matched;
+        for (i = 0; i < f->count; i++) {
+            if (Fusion_Overlap(f, f->pulses[i].start, f->pulses[i].end, f->analog_start, t)) {
+                f->pulses[i].confirmed = 1;
+                matched = 1;
+            }
+        }
+        // 比较器正处于按键中，且开始于这个模拟按键内，等它结束时再确认
+        if (f->digital_level && !FUSION_BEFORE(t + f->tol_us, f->digital_start)) {
+            matched = 1;
+        }
+        // 比较器漏掉的按键，不早于已放出的边沿
+        uint32_t start = FUSION_BEFORE(f->analog_start, f->emitted) ? f->emitted : f->analog_start;
+        if (!matched && FUSION_BEFORE(start, t)) {
+            Fusion_Insert(f, start, t, 1);
+        }
+    }
+    f->analog_time = t;
+
+    // 模拟判决已越过结束时刻（再加tol）的脉冲，是否重叠已成定局
+    while (f->count > 0 && !FUSION_BEFORE(t, f->pulses[0].end + f->tol_us)) {
+        if (f->analog_level && !FUSION_BEFORE(f->pulses[0].end, f->analog_start - f->tol_us)) {
+            f->pulses[0].confirmed = 1;
+            f->analog_matched = 1;
+        }
+        Fusion_Pop(f);
+    }
+}
+
+uint32_t Fusion_Settled(Fusion *f) {
+    uint32_t settled = f->analog_time - f->tol_us;
+
+    if (f->count > 0 && FUSION_BEFORE(f->pulses[0].start, settled)) {
+        settled = f->pulses[0].start;
+    }
+    if (f->digital_level && FUSION_BEFORE(f->digital_start, settled)) {
+        settled = f->digital_start;
+    }
+    if (f->analog_level && FUSION_BEFORE(f->analog_start, settled)) {
+        settled = f->analog_start;  // 可能要补一个从这里开始的脉冲
+    }
+    return settled;
+}
+
+uint8_t Fusion_Idle(const Fusion *f) {
+    return f->count == 0 && f->out_head == f->out_tail && !f->digital_level && !f->analog_level;
+}
+
+uint8_t Fusion_Read(Fusion *f, uint32_t *ts, uint8_t *level) {
+    if (f->out_head == f->out_tail) {
+        return 0;
+    }
+    *ts = f->out_ts[f->out_tail & (FUSION_OUT_LEN - 1)];
+    *level = f->out_level[f->out_tail & (FUSION_OUT_LEN - 1)];
+    f->out_tail++;
+    return 1;
+}
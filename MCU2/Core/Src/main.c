@@ -1,114 +1,604 @@
-
 #include "main.h"
+#include "channel.h"
+#include "capture.h"
+#include "fusion.h"
+#include "sampler.h"
+#include "timebase.h"
+#include "goertzel.h"
+#include "mfsk.h"
+#include "uart_tx.h"
+#include "power.h"
+#if USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#endif
 
 #include <stdio.h>  // 包含 sprintf 函数的声明
-#include <string.h> // 包含 strlen 函数的声明
 
 ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+DMA_HandleTypeDef hdma_tim2_ch1;
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 void SystemClock_Config(void);
 static void MX_USART2_UART_Init(void);
 static void MX_ADC1_Init(void);
 static void MX_GPIO_Init(void);
-uint16_t Read_ADC(void);
+static void MX_DMA_Init(void);
+static void MX_TIM2_Init(void);
+static void MX_TIM3_Init(void);
+static void DWT_Init(void);
 uint8_t Read_DO(void);
 
-#define MAX_MORSE_LENGTH 6  // 摩尔斯电码单个字符的最大长度
-#define CHAR_GAP_MS 1000    // 字符间隔时间（毫秒）
-#define DOT_LENGTH 50     // 点的长度（毫秒）
-#define DASH_LENGTH 150     // 划的长度（毫秒）
-
-volatile uint32_t signal_start_time = 0;
-volatile uint32_t signal_end_time = 0;
-volatile uint8_t signal_detected = 0;
-char morseCodeString[MAX_MORSE_LENGTH + 1] = {0};  // 存储摩尔斯电码的字符串
-int morseCodeIndex = 0;  // 摩尔斯电码的当前索引位置
-uint32_t last_signal_end_time = 0;  // 上一个信号的结束时间
-
-const char* MORSE_CODE_TABLE[36] = {
-    ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---",
-    "-.-", ".-..", "--", "-.", "---", ".--.", "--.-", ".-.", "...", "-",
-    "..-", "...-", ".--", "-..-", "-.--", "--..", "-----", ".----", "..---",
-    "...--", "....-", ".....", "-....", "--...", "---..", "----."
-};
-
-// 查找摩尔斯电码对应的字母或数字
-char MorseCodeToChar(const char* morseCode) {
-    for (int i = 0; i < 36; i++) {
-        if (strcmp(morseCode, MORSE_CODE_TABLE[i]) == 0) {
-            return i < 26 ? 'A' + i : '0' + (i - 26);
+#define RX_EARLY_COMMIT 1 // 1: 点划已唯一确定字符时立即输出，判断错误时再补发退格（仅单路接收）
+
+// 1: 用PA1模拟信号分 RX_CHANNELS 路检测各频率的能量判断按键（抗宽带噪声，可同时解码多个发送端）
+// 0: 用PA0比较器数字输出的边沿（时间分辨率1us），只有一路
+#define RX_USE_ANALOG 0
+#define RX_MIN_DWELL_US 5000  // 数字通道：短于5ms的脉冲（按键中掉线、间隔中的尖峰）视为抖动丢弃
+// 数字通道 1: 边沿时间仍取PA0，但每个脉冲须经PA1第0路音调能量确认，比较器的毛刺丢弃、漏掉的按键补上，
+//           解码比纯数字通道晚约4块（32ms）
+#define RX_FUSE_ANALOG 1
+#define RX_FUSE_DELAY_US ((RX_DWELL_BLOCKS * 2 - 1) * SAMPLER_BLOCK_US / 2)  // 模拟判决比实际边沿约晚1.5块
+#define RX_FUSE_TOL_US SAMPLER_BLOCK_US  // 模拟判决的边沿时间只精确到块
+// 数字通道 1: 线路空闲超过 RX_STOP_IDLE_US、字符已全部输出后进入STOP，PA0上升沿唤醒（见 power.h）
+#define RX_STOP_WHEN_IDLE 1
+#define RX_STOP_IDLE_US 2000000U  // 须长于最慢速度下的单词间隔
+#define RX_WAKE_REPORT 0          // 1: 每次唤醒把唤醒延迟打印到串口，否则只更新 rx_wake_us
+#define RX_USE_STOP (RX_STOP_WHEN_IDLE && !USE_FREERTOS && !LINK_USE_MFSK && !RX_USE_ANALOG)
+
+#if USE_FREERTOS
+// 任务优先级：捕获最高，不会被串口输出耽误；DSP其次，其余空闲时间都可以用来算Goertzel
+#define RX_PRIO_CAPTURE 4
+#define RX_PRIO_DSP 3
+#define RX_PRIO_DECODE 2
+#define RX_PRIO_OUTPUT 1
+// 各任务栈大小（字）
+#define RX_STACK_CAPTURE 256
+#define RX_STACK_DSP 384
+#define RX_STACK_DECODE 384
+#define RX_STACK_OUTPUT 256
+#define RX_EVENT_QUEUE_LEN 32   // 捕获/DSP到解码的事件数
+#define RX_TEXT_QUEUE_LEN 128   // 解码到输出的字符数
+#define RX_POST_TIMEOUT_MS 2    // 事件队列满时捕获任务最多等待的时间，超时丢弃并让解码任务重新定起点
+#define RX_IDLE_MS 10           // 数字通道：解码任务无事件时每10ms按当前时间判断一次线路空闲
+#define RX_STACK_REPORT_MS 0    // 非0时按此周期（毫秒）把各任务的栈余量打印到串口，否则只更新 rx_stack_free
+#endif
+
+MorseTiming timing;                 // 约定的发送速度，作为速度估计的初值
+RxChannel channels[RX_CHANNELS];    // 各路的解码状态，数字通道只用第0路
+#if RX_FUSE_ANALOG
+Fusion fusion;                      // 数字通道边沿的模拟确认
+#endif
+uint32_t sampler_start;             // 采样启动时的 Timebase_Now，采样块时间加上它即换算到捕获时基
+
+volatile uint32_t goertzel_cycles = 0;   // 最近一块Goertzel的耗时（CPU周期）
+volatile uint32_t goertzel_cycles_max = 0;
+#if RX_USE_STOP
+volatile uint32_t rx_wake_us = 0;        // 最近一次从PA0边沿到恢复捕获的时间（微秒）
+volatile uint32_t rx_wake_us_max = 0;
+volatile uint32_t rx_wake_count = 0;
+#endif
+
+#if LINK_USE_MFSK
+#if SAMPLER_RATE_HZ / SAMPLER_BLOCK_LEN != MFSK_BIN_HZ
+#error "MFSK频率间隔必须等于采样块的DFT频点间隔"
+#endif
+Goertzel mfsk_bins[MFSK_TONES];          // 每个MFSK频率一个Goertzel滤波器
+MfskDecoder mfsk;
+volatile float mfsk_power = 0;           // 最近一块最强频率上的幅度平方
+#endif
+
+#if USE_FREERTOS
+// 捕获、DSP任务送给解码任务的事件
+typedef struct {
+    uint8_t type;   // RX_EVENT_EDGE、RX_EVENT_BLOCK 或 RX_EVENT_RESYNC
+    uint8_t value;  // 边沿、重新定起点：之后的电平；块：Process_Block 的返回值
+    uint32_t ts;    // 边沿：捕获时间戳；块：该块结束时刻（从采样启动算起）；重新定起点：此后的边沿都会送到，均为微秒
+} RxEvent;
+#define RX_EVENT_EDGE 0
+#define RX_EVENT_BLOCK 1
+#define RX_EVENT_RESYNC 2
+
+static QueueHandle_t rx_events;
+static QueueHandle_t rx_text;
+static TaskHandle_t rx_dsp_task = NULL;
+volatile UBaseType_t rx_stack_free[4];  // 捕获、DSP、解码、输出任务栈的历史最小余量（字）
+volatile uint32_t rx_event_drops = 0;   // 事件队列满而丢弃的边沿数
+
+// 解码输出交给输出任务，队列满时丢弃
+static uint16_t Rx_Write(const uint8_t *data, uint16_t len) {
+    uint16_t count = 0;
+
+    while (count < len && xQueueSend(rx_text, &data[count], 0) == pdPASS) {
+        count++;
+    }
+    return count;
+}
+#else
+#define Rx_Write UartTx_Write
+#endif
+
+// 记录一块处理的耗时
+static void Goertzel_Cycles(uint32_t start) {
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    goertzel_cycles = cycles;
+    if (cycles > goertzel_cycles_max) {
+        goertzel_cycles_max = cycles;
+    }
+}
+
+#if LINK_USE_MFSK
+// MFSK的块处理：求各频率上的能量，返回能量最大的频率序号，全部低于门限时返回-1
+int8_t Process_Mfsk(const uint16_t *block) {
+    uint32_t start = DWT->CYCCNT;
+    float best_power = TONE_POWER_ON;
+    int8_t best = -1;
+
+    for (uint8_t i = 0; i < MFSK_TONES; i++) {
+        float power = Goertzel_Power(&mfsk_bins[i], block);
+        if (power >= best_power) {
+            best_power = power;
+            best = (int8_t)i;
         }
     }
-    return '\0';
+    Goertzel_Cycles(start);
+    mfsk_power = best_power;
+    return best;
+}
+
+// 每块判定一次最强的频率，由频率变化切分符号
+static void Decode_Mfsk(int8_t tone) {
+    char c = Mfsk_Block(&mfsk, tone);
+    if (c != '\0') {
+        Rx_Write((uint8_t*)&c, 1);
+    }
+}
+#elif RX_USE_ANALOG
+// 模拟通道的块处理：每路各自求能量判定按键，返回各路判决的位图
+uint8_t Process_Block(const uint16_t *block) {
+    uint32_t start = DWT->CYCCNT;
+    uint8_t levels = 0;
+
+    for (uint8_t i = 0; i < RX_CHANNELS; i++) {
+        levels |= Channel_Detect(&channels[i], block) << i;
+    }
+    Goertzel_Cycles(start);
+    return levels;
+}
+
+// 按各路判决解码，时间取该块结束时刻
+static void Decode_Block(uint8_t levels, uint32_t now) {
+    for (uint8_t i = 0; i < RX_CHANNELS; i++) {
+        Channel_Level(&channels[i], (levels >> i) & 1, now);
+    }
+}
+#else
+// 数字通道时模拟通道只看第0路频率，融合时用其判决确认边沿，否则仅供监视；返回该块是否为按键
+uint8_t Process_Block(const uint16_t *block) {
+    uint32_t start = DWT->CYCCNT;
+
+    uint8_t level = Channel_Detect(&channels[0], block);
+    Goertzel_Cycles(start);
+    return level;
 }
 
-uint8_t Detect_Morse_Code(void) {
-    uint32_t duration = 0;
-    uint8_t code = 0;    // 0表示无信号，1表示点，2表示划
+// 去抖后的数字边沿：融合时先等模拟通道确认，否则直接送解码器；返回是否已送解码器
+static uint8_t Digital_Edge(uint32_t timestamp, uint8_t level) {
+#if RX_FUSE_ANALOG
+    Fusion_Digital(&fusion, timestamp, level);
+    return 0;
+#else
+    Channel_Edge(&channels[0], timestamp, level);
+    return 1;
+#endif
+}
 
-    // 等待PA0变为高电平
-    while(HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_RESET);
+// 处理DMA已捕获的全部边沿，不再忙等PA0；保持够久的交给edge，返回其结果的或
+static uint8_t Capture_Poll(EdgeDebounce *debounce, uint8_t (*edge)(uint32_t, uint8_t)) {
+    uint32_t raw_ts, timestamp;
+    uint8_t raw_level, level;
+    uint8_t result = 0;
 
-    // 开始计时
-    uint32_t start_time = HAL_GetTick();
+    while (Capture_Read(&raw_ts, &raw_level)) {
+        if (EdgeDebounce_Poll(debounce, raw_ts, &timestamp, &level)) {
+            result |= edge(timestamp, level);
+        }
+        EdgeDebounce_Edge(debounce, raw_ts, raw_level);
+    }
+    if (EdgeDebounce_Poll(debounce, Timebase_Now(), &timestamp, &level)) {
+        result |= edge(timestamp, level);
+    }
+    return result;
+}
 
-    // 等待PA0变回低电平
-    while(HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_SET);
+#if RX_FUSE_ANALOG
+// 模拟判决每跟上一块，放出已确认的边沿；线路空闲也只能判断到已确定的时刻，
+// 原始边沿（含毛刺）会作废TIM2的间隔超时，融合时不用它
+static void Decode_Fused(uint8_t tone, uint32_t now) {
+    RxChannel *rx = &channels[0];
+    uint32_t timestamp;
+    uint8_t level;
+
+    Fusion_Analog(&fusion, now, tone);
+    while (Fusion_Read(&fusion, &timestamp, &level)) {
+        Channel_Edge(rx, timestamp, level);
+    }
+    uint32_t settled = Fusion_Settled(&fusion);
+    if ((int32_t)(settled - rx->last_end) > 0) {
+        Channel_Idle(rx, settled);
+    }
+}
+#endif
+#endif
 
-    // 计算持续时间
-    duration = HAL_GetTick() - start_time;
+#if RX_USE_STOP
+// 线路空闲够久、边沿和模拟判决都已处理完时返回1
+static uint8_t Rx_Idle(const EdgeDebounce *debounce) {
+    RxChannel *rx = &channels[0];
 
-    // 根据持续时间判断是点还是划
-    if(duration >= DOT_LENGTH && duration < DASH_LENGTH) {
-        code = 1; // 点
-    } else if(duration >= DASH_LENGTH) {
-        code = 2; // 划
+    if (debounce->pending || debounce->level || rx->level
+        || Timebase_Elapsed(rx->last_end) < RX_STOP_IDLE_US) {
+        return 0;
+    }
+#if RX_FUSE_ANALOG
+    if (!Fusion_Idle(&fusion)) {
+        return 0;
     }
+#endif
+    return 1;
+}
 
-    return code;
+// 进入STOP等待下一次发送。唤醒时第一个点划已经开始，TIM2停走，捕获错过了它的上升沿，
+// 逐边沿翻转的电平因此失步：先按PA0重新定起点，仍为高电平时按唤醒期间TIM2走过的计数倒推补上上升沿；
+// 唤醒后PA0已回到低电平的只是尖峰，不补。由其他中断唤醒的不记入唤醒延迟
+static void Rx_Stop(EdgeDebounce *debounce) {
+    uint32_t wake_us, tim_us;
+    if (!Power_StopUntilEdge(&wake_us, &tim_us)) {
+        return;
+    }
+    if (Capture_Resync()) {
+        EdgeDebounce_Edge(debounce, Timebase_Now() - tim_us, 1);
+    }
+    rx_wake_us = wake_us;
+    if (wake_us > rx_wake_us_max) {
+        rx_wake_us_max = wake_us;
+    }
+    rx_wake_count++;
+#if RX_WAKE_REPORT
+    char msg[32];
+    int len = sprintf(msg, "\r\n[wake] %lu us\r\n", (unsigned long)wake_us);
+    UartTx_Write((uint8_t*)msg, (uint16_t)len);
+#endif
+}
+#endif
+
+#if USE_FREERTOS
+#if !LINK_USE_MFSK && !RX_USE_ANALOG
+static uint8_t rx_capture_lost = 0;  // 有边沿被丢弃，解码任务尚未重新定起点
+#if !RX_FUSE_ANALOG
+static volatile uint32_t rx_capture_settled;  // 此时刻之前的边沿都已送入事件队列，解码任务的空闲判断只能用到这里
+#endif
+
+// 去抖后的边沿送给解码任务，队列满时最多等 RX_POST_TIMEOUT_MS。丢了一个之后，
+// 在重新定起点的事件送出之前其余边沿也不再送，解码任务不会收到缺了一半的脉冲
+static uint8_t Capture_Post(uint32_t timestamp, uint8_t level) {
+    RxEvent ev = {RX_EVENT_EDGE, level, timestamp};
+
+    if (rx_capture_lost || xQueueSend(rx_events, &ev, pdMS_TO_TICKS(RX_POST_TIMEOUT_MS)) != pdPASS) {
+        rx_capture_lost = 1;
+        rx_event_drops++;
+        return 0;
+    }
+    return 1;
 }
 
+// 捕获任务：每个节拍取一次DMA捕获的边沿。时间戳由硬件记录，轮询周期只影响延迟
+static void Rx_CaptureTask(void *arg) {
+    EdgeDebounce debounce;
+    TickType_t wake = xTaskGetTickCount();
+
+    EdgeDebounce_Init(&debounce, RX_MIN_DWELL_US, 0);
+    for (;;) {
+        uint32_t now = Timebase_Now();
+        Capture_Poll(&debounce, Capture_Post);
+        if (rx_capture_lost) {
+            // 去抖器在队列之前，状态没有受影响：把它已确认的电平交给解码任务作为新起点，
+            // 早于 now - RX_MIN_DWELL_US 的边沿都已放出，之后的照常送
+            RxEvent ev = {RX_EVENT_RESYNC, debounce.level, now - RX_MIN_DWELL_US};
+            if (xQueueSend(rx_events, &ev, 0) == pdPASS) {
+                rx_capture_lost = 0;
+            }
+        }
+#if !RX_FUSE_ANALOG
+        if (!rx_capture_lost) {
+            rx_capture_settled = now - RX_MIN_DWELL_US;
+        }
+#endif
+        vTaskDelayUntil(&wake, 1);
+    }
+}
+#endif
+
+// DSP任务：采满一块由ADC回调通知，求能量后把判决交给解码任务
+static void Rx_DspTask(void *arg) {
+    const uint16_t *block;
+    uint32_t seq;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while ((block = Sampler_GetBlock(&seq)) != NULL) {
+            RxEvent ev = {RX_EVENT_BLOCK, 0, (seq + 1) * SAMPLER_BLOCK_US};
+#if LINK_USE_MFSK
+            ev.value = (uint8_t)Process_Mfsk(block);
+#else
+            ev.value = Process_Block(block);
+#endif
+            xQueueSend(rx_events, &ev, portMAX_DELAY);
+        }
+    }
+}
+
+// 处理一个事件。边沿和块来自两个任务，队列里的顺序不一定是时间顺序：
+// 融合时由 Fusion_Digital 丢弃早于已放出时刻的脉冲，纯数字通道只有边沿，本来就按时间顺序
+static void Rx_Dispatch(const RxEvent *ev) {
+#if LINK_USE_MFSK
+    Decode_Mfsk((int8_t)ev->value);
+#elif RX_USE_ANALOG
+    Decode_Block(ev->value, ev->ts);
+#elif RX_FUSE_ANALOG
+    if (ev->type == RX_EVENT_EDGE) {
+        Digital_Edge(ev->ts, ev->value);
+    } else if (ev->type == RX_EVENT_RESYNC) {
+        Fusion_Resync(&fusion, ev->ts, ev->value);
+    } else {
+        Decode_Fused(ev->value, sampler_start + ev->ts);
+    }
+#else
+    if (ev->type == RX_EVENT_EDGE) {
+        Digital_Edge(ev->ts, ev->value);
+    } else if (ev->type == RX_EVENT_RESYNC) {
+        Channel_Reset(&channels[0], ev->ts, ev->value);
+    }
+#endif
+}
+
+// 解码任务：按时间顺序处理边沿和块判决，输出写入字符队列
+static void Rx_DecodeTask(void *arg) {
+    RxEvent ev;
+
+    for (;;) {
+        if (xQueueReceive(rx_events, &ev, pdMS_TO_TICKS(RX_IDLE_MS)) == pdPASS) {
+            Rx_Dispatch(&ev);
+        }
+#if !LINK_USE_MFSK && !RX_USE_ANALOG && !RX_FUSE_ANALOG
+        // 先读捕获任务的进度再取完队列：进度之前的边沿在它更新之前都已入队，
+        // 空闲判断不会越过还在队列里、或捕获任务被耽误而尚未送出的边沿
+        RxChannel *rx = &channels[0];
+        uint32_t settled = rx_capture_settled;
+        while (xQueueReceive(rx_events, &ev, 0) == pdPASS) {
+            Rx_Dispatch(&ev);
+        }
+        if ((int32_t)(settled - rx->last_end) > 0) {
+            Channel_Idle(rx, settled);
+        }
+#endif
+    }
+}
+
+// 输出任务：优先级最低，把解码出的字符写入串口发送缓冲，并记录各任务的栈余量
+static void Rx_OutputTask(void *arg) {
+    TaskHandle_t tasks[4];
+    uint8_t c;
+#if RX_STACK_REPORT_MS
+    TickType_t last_report = xTaskGetTickCount();
+#endif
+
+    tasks[0] = xTaskGetHandle("capture");
+    tasks[1] = xTaskGetHandle("dsp");
+    tasks[2] = xTaskGetHandle("decode");
+    tasks[3] = xTaskGetHandle("output");
+    for (;;) {
+        if (xQueueReceive(rx_text, &c, pdMS_TO_TICKS(1000)) == pdPASS) {
+            UartTx_Write(&c, 1);
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            rx_stack_free[i] = tasks[i] != NULL ? uxTaskGetStackHighWaterMark(tasks[i]) : 0;
+        }
+#if RX_STACK_REPORT_MS
+        if (xTaskGetTickCount() - last_report >= pdMS_TO_TICKS(RX_STACK_REPORT_MS)) {
+            char msg[80];
+            int len = sprintf(msg, "\r\n[stack] cap %u dsp %u dec %u out %u drop %lu\r\n",
+                              (unsigned)rx_stack_free[0], (unsigned)rx_stack_free[1],
+                              (unsigned)rx_stack_free[2], (unsigned)rx_stack_free[3],
+                              (unsigned long)rx_event_drops);
+            UartTx_Write((uint8_t*)msg, (uint16_t)len);
+            last_report = xTaskGetTickCount();
+        }
+#endif
+    }
+}
+
+// 建立队列和任务并启动调度器，不返回
+static void Rx_StartTasks(void) {
+    rx_events = xQueueCreate(RX_EVENT_QUEUE_LEN, sizeof(RxEvent));
+    rx_text = xQueueCreate(RX_TEXT_QUEUE_LEN, sizeof(uint8_t));
+    if (rx_events == NULL || rx_text == NULL) {
+        Error_Handler();
+    }
+    Channel_SetOutput(Rx_Write);
+#if !LINK_USE_MFSK && !RX_USE_ANALOG
+    xTaskCreate(Rx_CaptureTask, "capture", RX_STACK_CAPTURE, NULL, RX_PRIO_CAPTURE, NULL);
+#endif
+    xTaskCreate(Rx_DspTask, "dsp", RX_STACK_DSP, NULL, RX_PRIO_DSP, &rx_dsp_task);
+    xTaskCreate(Rx_DecodeTask, "decode", RX_STACK_DECODE, NULL, RX_PRIO_DECODE, NULL);
+    xTaskCreate(Rx_OutputTask, "output", RX_STACK_OUTPUT, NULL, RX_PRIO_OUTPUT, NULL);
+    vTaskStartScheduler();
+    Error_Handler();  // 堆不够建立空闲任务时才会返回
+}
+
+// 在ADC回调里调用：唤醒DSP任务
+static void Rx_BlockReadyFromISR(void) {
+    BaseType_t woken = pdFALSE;
+
+    if (rx_dsp_task != NULL) {
+        vTaskNotifyGiveFromISR(rx_dsp_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name) {
+    Error_Handler();
+}
+#endif
+
 /* Main function */
 int main(void) {
     HAL_Init();
     SystemClock_Config();
+    DWT_Init();
     MX_GPIO_Init();
+    MX_DMA_Init();
     MX_ADC1_Init();
     MX_USART2_UART_Init();
+    UartTx_Init(&huart2);
+    MX_TIM2_Init();
+    MX_TIM3_Init();
+#if RX_USE_STOP
+    Power_Init();
+#endif
+    MorseTiming_Init(&timing, MORSE_WPM, MORSE_CHAR_WPM);
+#if RX_USE_ANALOG
+    static const uint16_t freqs[RX_CHANNELS] = RX_CHANNEL_FREQS;
+    for (uint8_t i = 0; i < RX_CHANNELS; i++) {
+        Channel_Init(&channels[i], (char)('0' + i), freqs[i], &timing, 0);
+    }
+#else
+    Channel_Init(&channels[0], 0, MORSE_TONE_HZ, &timing, RX_EARLY_COMMIT);
+#endif
+#if LINK_USE_MFSK
+    for (uint8_t i = 0; i < MFSK_TONES; i++) {
+        Goertzel_Init(&mfsk_bins[i], MFSK_TONE_HZ(i), SAMPLER_RATE_HZ, SAMPLER_BLOCK_LEN);
+    }
+    Mfsk_DecoderInit(&mfsk);
+#endif
+    Capture_Init(&htim2);
+    // TIM2与TIM3同一时钟，采样块的时间加上启动时刻即换算到捕获时基
+    sampler_start = Timebase_Now();
+#if !RX_USE_ANALOG && RX_FUSE_ANALOG
+    Fusion_Init(&fusion, RX_FUSE_DELAY_US, RX_FUSE_TOL_US, sampler_start);
+#endif
+#if !RX_USE_ANALOG
+    channels[0].last_end = sampler_start;
+#endif
+    Sampler_Init(&hadc1, &htim3);
+
+#if USE_FREERTOS
+    Rx_StartTasks();
+#else
+#if !LINK_USE_MFSK && !RX_USE_ANALOG
+    RxChannel *rx = &channels[0];
+    EdgeDebounce debounce;
+    EdgeDebounce_Init(&debounce, RX_MIN_DWELL_US, 0);
+#endif
 
     while (1) {
-        uint32_t current_time = HAL_GetTick();
-        uint8_t morseCodeSignal = Detect_Morse_Code();
+        const uint16_t *block;
+        uint32_t seq;
 
-        if (morseCodeSignal) {
-            morseCodeString[morseCodeIndex++] = morseCodeSignal == 1 ? '.' : '-';
-            last_signal_end_time = current_time;
+#if LINK_USE_MFSK
+        if ((block = Sampler_GetBlock(&seq)) != NULL) {
+            Decode_Mfsk(Process_Mfsk(block));
         }
-
-        if ((current_time - last_signal_end_time >= CHAR_GAP_MS && morseCodeIndex > 0) || morseCodeIndex == MAX_MORSE_LENGTH) {
-            morseCodeString[morseCodeIndex] = '\0';  // 结束字符串
-            char letter = MorseCodeToChar(morseCodeString);
-            if (letter != '\0') {
-                char msg[2] = {letter, '\0'};
-                HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
+#elif RX_USE_ANALOG
+        if ((block = Sampler_GetBlock(&seq)) != NULL) {
+            Decode_Block(Process_Block(block), (seq + 1) * SAMPLER_BLOCK_US);
+        }
+#else
+        uint8_t edges = Capture_Poll(&debounce, Digital_Edge);
+
+        if ((block = Sampler_GetBlock(&seq)) != NULL) {
+#if RX_FUSE_ANALOG
+            Decode_Fused(Process_Block(block), sampler_start + (seq + 1) * SAMPLER_BLOCK_US);
+#else
+            Process_Block(block);
+#endif
+        }
+        // 间隔开始后按当前门限布置超时，到点由TIM2比较中断通知，而不必等下一个边沿
+        if (edges && rx->level == 0) {
+            Capture_ArmGap(rx->last_end + MorseDecoder_CharGapUs(&rx->decoder),
+                           rx->last_end + MorseDecoder_WordGapUs(&rx->decoder));
+        }
+        if (Capture_GapEvent()) {
+            Channel_Idle(rx, Timebase_Now());
+        }
+#if RX_USE_STOP
+        // 最后的字母和单词间隔输出并发送完后才停
+        if (Rx_Idle(&debounce)) {
+            Channel_Idle(rx, Timebase_Now());
+            if (UartTx_Idle()) {
+                Rx_Stop(&debounce);
             }
-            morseCodeIndex = 0;
-            memset(morseCodeString, 0, sizeof(morseCodeString));
         }
+#endif
+#endif
     }
+#endif
+}
+
+// 打开DWT周期计数器，用于测量处理耗时
+static void DWT_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 uint8_t Read_DO(void) {
     return (uint8_t)HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0);
 }
 
-uint16_t Read_ADC(void) {
-    HAL_ADC_Start(&hadc1);
-    if (HAL_ADC_PollForConversion(&hadc1, HAL_MAX_DELAY) == HAL_OK) {
-        return HAL_ADC_GetValue(&hadc1);
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM2) {
+        Capture_GapElapsed(htim);
+    }
+}
+
+#if USE_FREERTOS
+// TIM7代替SysTick作为HAL时基
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM7) {
+        HAL_IncTick();
+    }
+}
+#endif
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART2) {
+        UartTx_Cplt();
+    }
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) {
+    if (hadc->Instance == ADC1) {
+        Sampler_HalfCplt();
+#if USE_FREERTOS
+        Rx_BlockReadyFromISR();
+#endif
+    }
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc) {
+    if (hadc->Instance == ADC1) {
+        Sampler_Cplt();
+#if USE_FREERTOS
+        Rx_BlockReadyFromISR();
+#endif
     }
-    return 0; // 或者您可以选择一个合适的错误处理方式
 }
 
 /**
@@ -169,13 +659,14 @@ static void MX_ADC1_Init(void)
   hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
   hadc1.Init.Resolution = ADC_RESOLUTION_12B;
   hadc1.Init.ScanConvMode = DISABLE;
-  hadc1.Init.ContinuousConvMode = ENABLE;
+  /* 每个TIM3更新事件转换一次，采样间隔由定时器决定而不是ADC连续转换 */
+  hadc1.Init.ContinuousConvMode = DISABLE;
   hadc1.Init.DiscontinuousConvMode = DISABLE;
-  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
-  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T3_TRGO;
   hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
   hadc1.Init.NbrOfConversion = 1;
-  hadc1.Init.DMAContinuousRequests = DISABLE;
+  hadc1.Init.DMAContinuousRequests = ENABLE;
   hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
   if (HAL_ADC_Init(&hadc1) != HAL_OK)
   {
@@ -184,7 +675,8 @@ static void MX_ADC1_Init(void)
 
   sConfig.Channel = ADC_CHANNEL_1;
   sConfig.Rank = 1;
-  sConfig.SamplingTime = ADC_SAMPLETIME_3CYCLES;
+  /* 21MHz ADC时钟下 84+12 周期约4.6us，远小于62.5us的采样间隔 */
+  sConfig.SamplingTime = ADC_SAMPLETIME_84CYCLES;
   if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
   {
     Error_Handler();
@@ -194,6 +686,115 @@ static void MX_ADC1_Init(void)
 }
 
 
+static void MX_TIM2_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_IC_InitTypeDef sConfigIC = {0};
+  TIM_OC_InitTypeDef sConfigOC = {0};
+
+  /* 84MHz / 84 = 1MHz，32位计数器自由运行，约71分钟回绕一次 */
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = 84 - 1;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = 0xFFFFFFFF;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_IC_Init(&htim2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* PA0 上升沿和下降沿都捕获，滤波 fDTS/32 N=8（约3us）去掉比较器毛刺 */
+  sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_BOTHEDGE;
+  sConfigIC.ICSelection = TIM_ICSELECTION_DIRECTTI;
+  sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+  sConfigIC.ICFilter = 0x0F;
+  if (HAL_TIM_IC_ConfigChannel(&htim2, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* CH3/CH4 只作定时比较（不输出到引脚），用于字母/单词间隔超时 */
+  sConfigOC.OCMode = TIM_OCMODE_TIMING;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  if (HAL_TIM_OC_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_OC_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+static void MX_TIM3_Init(void)
+{
+  TIM_ClockConfigTypeDef sClockSourceConfig = {0};
+  TIM_MasterConfigTypeDef sMasterConfig = {0};
+
+  /* 84MHz / SAMPLER_RATE_HZ，每次更新事件经TRGO触发一次ADC转换 */
+  htim3.Instance = TIM3;
+  htim3.Init.Prescaler = 0;
+  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim3.Init.Period = 84000000 / SAMPLER_RATE_HZ - 1;
+  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  if (HAL_TIM_Base_Init(&htim3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  if (HAL_TIM_ConfigClockSource(&htim3, &sClockSourceConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+  sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  /* DMA2_Stream0_IRQn interrupt configuration */
+#if USE_FREERTOS
+  // ADC回调里要通知DSP任务，优先级不能高于 configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 5, 0);
+#else
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 0, 0);
+#endif
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+}
+
 static void MX_USART2_UART_Init(void)
 {
 
@@ -234,12 +835,6 @@ static void MX_GPIO_Init(void)
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(B1_GPIO_Port, &GPIO_InitStruct);
 
-  /*Configure GPIO pin : PA0 */
-  GPIO_InitStruct.Pin = GPIO_PIN_0;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-  GPIO_InitStruct.Pull = GPIO_NOPULL;
-  HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
   /*Configure GPIO pin : LD2_Pin */
   GPIO_InitStruct.Pin = LD2_Pin;
   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
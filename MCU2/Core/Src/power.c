@@ -0,0 +1,52 @@
+#include "power.h"
+
+void Power_Init(void) {
+    // PA0保持TIM2_CH1复用功能，另开EXTI线0的上升沿，只在STOP期间打开中断屏蔽
+    SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI0;
+    EXTI->RTSR |= EXTI_RTSR_TR0;
+    EXTI->IMR &= ~EXTI_IMR_MR0;
+    HAL_NVIC_SetPriority(EXTI0_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(EXTI0_IRQn);
+#ifdef DEBUG
+    HAL_DBGMCU_EnableDBGStopMode();
+#endif
+}
+
+// STOP唤醒后系统时钟为HSI，PLL的配置仍保留，只需重新打开并切换，不必再走一遍 SystemClock_Config
+static void Power_RestoreClock(void) {
+    __HAL_RCC_PLL_ENABLE();
+    while (__HAL_RCC_GET_FLAG(RCC_FLAG_PLLRDY) == 0) {
+    }
+    __HAL_RCC_SYSCLK_CONFIG(RCC_SYSCLKSOURCE_PLLCLK);
+    while (__HAL_RCC_GET_SYSCLK_SOURCE() != RCC_SYSCLKSOURCE_STATUS_PLLCLK) {
+    }
+}
+
+uint8_t Power_StopUntilEdge(uint32_t *wake_us, uint32_t *tim_us) {
+    uint8_t edge = 0;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    // 先打开屏蔽再看电平：此后到来的上升沿都会挂起EXTI0，使STOP立即退出
+    EXTI->PR = EXTI_PR_PR0;
+    EXTI->IMR |= EXTI_IMR_MR0;
+    if (HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_RESET) {
+        HAL_SuspendTick();
+        HAL_PWR_EnterSTOPMode(PWR_MAINREGULATOR_ON, PWR_STOPENTRY_WFI);
+        // DWT按内核时钟计数：恢复PLL之前为HSI
+        uint32_t start = DWT->CYCCNT;
+        Power_RestoreClock();
+        uint32_t cycles = DWT->CYCCNT - start;
+        HAL_ResumeTick();
+        // ADC、串口等其他中断也会让WFI返回，只有EXTI0挂起才是PA0的上升沿
+        edge = (EXTI->PR & EXTI_PR_PR0) != 0;
+        *wake_us = POWER_STOP_WAKE_US + cycles / (HSI_VALUE / 1000000U);
+        // STOP退出期间TIM2停走；等PLL时按HSI计数（APB1二分频、定时器时钟加倍后仍为HSI），
+        // 每 PSC+1 个HSI周期才走1，不是每微秒走1
+        *tim_us = cycles / (TIM2->PSC + 1U);
+    }
+    EXTI->IMR &= ~EXTI_IMR_MR0;
+
+    __set_PRIMASK(primask);  // 挂起的EXTI0中断此时才执行，时钟已恢复
+    return edge;
+}
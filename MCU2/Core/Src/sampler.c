@@ -0,0 +1,50 @@
+#include "sampler.h"
+#include "ring_buffer.h"
+
+static uint16_t sampler_buf[SAMPLER_BLOCK_LEN * 2];  // DMA写入，前后两半轮流使用
+// 已采满的块：中断放出，主循环取走。位置掩码后正好是缓冲的前/后半；
+// 生产者是不会等待的DMA，中断照常放出，被覆盖的旧块由主循环跳过
+static Ring sampler_ring;
+static uint32_t sampler_seq = 0;                     // 下一个取出的块的序号
+static volatile uint32_t sampler_overruns = 0;
+
+void Sampler_Init(ADC_HandleTypeDef *hadc, TIM_HandleTypeDef *htim) {
+    if (!Ring_Init(&sampler_ring, 2)) {
+        Error_Handler();
+    }
+    sampler_seq = 0;
+    sampler_overruns = 0;
+    HAL_ADC_Start_DMA(hadc, (uint32_t*)sampler_buf, SAMPLER_BLOCK_LEN * 2);
+    // ADC先就绪，再由定时器开始产生触发，保证第一个采样点对齐缓冲起点
+    HAL_TIM_Base_Start(htim);
+}
+
+void Sampler_HalfCplt(void) {
+    Ring_Publish(&sampler_ring, 1);
+}
+
+void Sampler_Cplt(void) {
+    Ring_Publish(&sampler_ring, 1);
+}
+
+const uint16_t *Sampler_GetBlock(uint32_t *seq) {
+    uint16_t count = Ring_Count(&sampler_ring);
+
+    if (count == 0) {
+        return NULL;
+    }
+    if (count > 1) {
+        // 上一块还没被处理就又采满了一块，只取最新的
+        sampler_overruns += count - 1;
+        sampler_seq += count - 1;
+        Ring_Consume(&sampler_ring, count - 1);
+    }
+    *seq = sampler_seq++;
+    const uint16_t *block = &sampler_buf[Ring_Tail(&sampler_ring) * SAMPLER_BLOCK_LEN];
+    Ring_Consume(&sampler_ring, 1);
+    return block;
+}
+
+uint32_t Sampler_Overruns(void) {
+    return sampler_overruns;
+}
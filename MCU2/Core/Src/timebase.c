@@ -0,0 +1,7 @@
+#include "main.h"
+#include "timebase.h"
+
+// TIM2由 MX_TIM2_Init 配置为1MHz、32位自由运行，Capture_Init 启动后一直计数，捕获的时间戳与此同一时基
+uint32_t Timebase_Now(void) {
+    return TIM2->CNT;
+}
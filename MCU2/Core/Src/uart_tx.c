@@ -0,0 +1,57 @@
+#include "uart_tx.h"
+#include "ring_buffer.h"
+
+static UART_HandleTypeDef *uart_tx_huart;
+static uint8_t uart_tx_buf[UART_TX_RING_SIZE];
+static Ring uart_tx_ring;                   // 主循环放入，发送完成后让出
+static volatile uint16_t uart_tx_len = 0;   // 正在DMA发送的字节数，0表示空闲
+
+// 把读取位置起连续的一段交给DMA，需在关中断或发送完成中断里调用
+static void UartTx_Kick(void) {
+    if (uart_tx_len != 0) {
+        return;
+    }
+    // 数据回绕时先发到缓冲末尾，剩下的下一段再发
+    uart_tx_len = Ring_Contiguous(&uart_tx_ring);
+    if (uart_tx_len != 0) {
+        HAL_UART_Transmit_DMA(uart_tx_huart, &uart_tx_buf[Ring_Tail(&uart_tx_ring)], uart_tx_len);
+    }
+}
+
+void UartTx_Init(UART_HandleTypeDef *huart) {
+    uart_tx_huart = huart;
+    if (!Ring_Init(&uart_tx_ring, UART_TX_RING_SIZE)) {
+        Error_Handler();
+    }
+    uart_tx_len = 0;
+}
+
+uint16_t UartTx_Write(const uint8_t *data, uint16_t len) {
+    uint16_t count = 0;
+    uint16_t room = Ring_Free(&uart_tx_ring);
+
+    // 缓冲已满时多出的字节丢弃
+    while (count < len && count < room) {
+        uart_tx_buf[(Ring_Head(&uart_tx_ring) + count) & (UART_TX_RING_SIZE - 1)] = data[count];
+        count++;
+    }
+    Ring_Publish(&uart_tx_ring, count);
+
+    // 缓冲本身不用关中断，这里只防止与发送完成中断同时启动DMA
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    UartTx_Kick();
+    __set_PRIMASK(primask);
+
+    return count;
+}
+
+uint8_t UartTx_Idle(void) {
+    return Ring_Count(&uart_tx_ring) == 0;
+}
+
+void UartTx_Cplt(void) {
+    Ring_Consume(&uart_tx_ring, uart_tx_len);
+    uart_tx_len = 0;
+    UartTx_Kick();
+}
@@ -1,9 +1,12 @@
 //test code pour the detector 
 #include "main.h"
+#include "uart_tx.h"
+#include "detector.h"
 
 ADC_HandleTypeDef hadc1;
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE BEGIN PV */
 #ifdef __GNUC__
@@ -13,10 +16,9 @@ UART_HandleTypeDef huart2;
 #define PUTCHAR_PROTOTYPE int fputc(int ch, FILE *f)
 #endif /* __GNUC__ */
 PUTCHAR_PROTOTYPE {
-    /* Place your implementation of fputc here */
-    /* e.g. write a character to the USART2 and Loop until the end of
-     transmission */
-    HAL_UART_Transmit(&huart2, (uint8_t*) &ch, 1, 0xFFFF);
+    /* 写入发送环形缓冲后立即返回，由DMA在后台发出 */
+    uint8_t c = (uint8_t) ch;
+    UartTx_Write(&c, 1);
     return ch;
 }
 /* USER CODE END PV */
@@ -24,6 +26,7 @@ PUTCHAR_PROTOTYPE {
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_ADC1_Init(void);
 /* USER CODE BEGIN PFP */
@@ -58,21 +61,27 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_ADC1_Init();
   /* USER CODE BEGIN 2 */
+  UartTx_Init(&huart2);
 
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   uint16_t adc_value;
+  Detector detector;  // 代替固定门限3000：跟踪噪声底和峰值，迟滞判决
+  Detector_Init(&detector, 200.0f, 1);
       while (1) {
           HAL_ADC_Start(&hadc1);
           if (HAL_ADC_PollForConversion(&hadc1, 100) == HAL_OK) {
               adc_value = HAL_ADC_GetValue(&hadc1);
               printf("%d\n\r",adc_value);
-              if (adc_value >= 3000){
+              // 以ADC中点为零，偏离中点的幅度送入检测器
+              float amplitude = adc_value >= 2048 ? adc_value - 2048 : 2048 - adc_value;
+              if (Detector_Update(&detector, amplitude)){
                   HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
                   HAL_Delay(100);
                   HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
@@ -223,6 +232,22 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -267,7 +292,13 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
-
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART2)
+  {
+    UartTx_Cplt();
+  }
+}
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,52 @@
+/* Build: gcc -I../Common/Inc beacon.c ../Common/Src/morse.c ../Common/Src/morse_timing.c ../Common/Src/morse_timeline.c -o beacon
+ * Usage: ./beacon HELLOCYU 24 [char_wpm] > ../MCU1/Core/Inc/beacon.h
+ *
+ * Expands a fixed beacon message into the keyer's run timeline (mark/space
+ * durations in microseconds) so MCU1 can play it straight from flash.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "morse_timeline.h"
+
+#define MAX_RUNS 1024
+
+int main(int argc, char *argv[])
+{
+    static uint32_t runs[MAX_RUNS];
+
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr, "usage: %s <message> <wpm> [char_wpm]\n", argv[0]);
+        return 1;
+    }
+    const char *text = argv[1];
+    int wpm = atoi(argv[2]);
+    int char_wpm = argc == 4 ? atoi(argv[3]) : wpm;
+    if (wpm <= 0 || wpm > 255 || char_wpm <= 0 || char_wpm > 255) {
+        fprintf(stderr, "wpm must be between 1 and 255\n");
+        return 1;
+    }
+
+    MorseTiming timing;
+    MorseTiming_Init(&timing, (uint8_t)wpm, (uint8_t)char_wpm);
+    uint16_t count = Morse_Timeline(text, &timing, runs, MAX_RUNS);
+    uint64_t total = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        total += runs[i];
+    }
+
+    printf("#ifndef _BEACON_H_\n#define _BEACON_H_\n#include <stdint.h>\n\n");
+    printf("// 由 codeMC1/beacon.c 生成，请勿手工修改：./beacon \"%s\" %d %d\n", text, wpm, char_wpm);
+    printf("// 点长 %u us，字母间隔 %u us，单词间隔 %u us，共 %u 段，总时长 %llu us\n",
+           timing.dot_us, timing.letter_gap_us, timing.word_gap_us, count, (unsigned long long)total);
+    printf("#define BEACON_TEXT \"%s\"  // 原文，MFSK模式下按文本发送\n", text);
+    printf("#define BEACON_DOT_US %uU\n", timing.dot_us);
+    printf("#define BEACON_RUN_COUNT %u\n\n", count);
+    printf("// 按键、间隔交替（微秒），用 Keyer_Play() 播放\n");
+    printf("static const uint32_t BEACON_RUNS[BEACON_RUN_COUNT] = {");
+    for (uint16_t i = 0; i < count; i++) {
+        printf("%s%u,", (i % 8) == 0 ? "\n    " : " ", runs[i]);
+    }
+    printf("\n};\n\n#endif\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* Build: gcc -O2 -std=c11 -I../MCU2/Core/Inc fusion_check.c ../MCU2/Core/Src/fusion.c -o fusion_check
+ * Usage: ./fusion_check
+ *
+ * Host check for MCU2's digital/analog fusion (fusion.c). Each scenario
+ * feeds comparator edges and per-block tone decisions the way the receiver
+ * does, then checks that the released edges alternate rising/falling, never
+ * go back in time, and match the expected sequence.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "fusion.h"
+
+/* Same values as MCU2's main.c: 8 ms blocks, analog decision ~1.5 blocks late */
+#define BLOCK_US 8000U
+#define DELAY_US 12000U
+#define TOL_US BLOCK_US
+#define END_US 600000U
+
+#define MAX_EDGES 32
+
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} Span;
+
+typedef struct {
+    const char *name;
+    Span analog;               /* tone present; {0, 0} for none */
+    Span digital[4];           /* comparator pulses, {0, 0} terminated */
+    uint32_t expect[MAX_EDGES]; /* released edges: rising, falling, ... */
+    int expect_count;
+} Scenario;
+
+static const Scenario scenarios[] = {
+    /* Comparator covers only the start of a dash: the dash must not be added again */
+    {"partial comparator pulse", {100000, 250000}, {{100000, 120000}}, {100000, 120000}, 2},
+    /* Comparator misses the mark entirely: one fill-in from the analog decision */
+    {"analog only", {100000, 250000}, {{0, 0}}, {100000, 252000}, 2},
+    /* Comparator glitch with no tone: dropped */
+    {"glitch only", {0, 0}, {{300000, 306000}}, {0}, 0},
+    /* Comparator drops out inside the mark: both parts kept, nothing filled in */
+    {"dropout inside mark", {100000, 250000}, {{100000, 160000}, {170000, 250000}},
+     {100000, 160000, 170000, 250000}, 4},
+    /* Both agree: the comparator's timing is kept */
+    {"both agree", {100000, 250000}, {{101000, 249000}}, {101000, 249000}, 2},
+};
+
+static int in_span(const Span *s, uint32_t t)
+{
+    return s->end != 0 && t >= s->start && t < s->end;
+}
+
+static int run(const Scenario *sc)
+{
+    Fusion f;
+    uint32_t got[MAX_EDGES];
+    uint8_t got_level[MAX_EDGES];
+    int count = 0;
+    int d = 0;
+    int digital_high = 0;
+    int ok = 1;
+    uint32_t ts;
+    uint8_t level;
+
+    Fusion_Init(&f, DELAY_US, TOL_US, 0);
+    for (uint32_t now = BLOCK_US; now <= END_US; now += BLOCK_US) {
+        /* Comparator edges inside this block, then the block's tone decision */
+        while (sc->digital[d].end != 0) {
+            uint32_t edge = digital_high ? sc->digital[d].end : sc->digital[d].start;
+            if (edge > now) {
+                break;
+            }
+            Fusion_Digital(&f, edge, (uint8_t)!digital_high);
+            if (digital_high) {
+                d++;
+            }
+            digital_high = !digital_high;
+        }
+        /* The block is judged on the tone state delayed by DELAY_US */
+        Fusion_Analog(&f, now, (uint8_t)in_span(&sc->analog, now - DELAY_US));
+        while (Fusion_Read(&f, &ts, &level)) {
+            if (count < MAX_EDGES) {
+                got[count] = ts;
+                got_level[count] = level;
+            }
+            count++;
+        }
+    }
+
+    printf("%-26s", sc->name);
+    for (int i = 0; i < count && i < MAX_EDGES; i++) {
+        printf(" %lu%s", (unsigned long)got[i], got_level[i] ? "^" : "v");
+        if (got_level[i] != (i % 2 == 0)) {
+            ok = 0;  /* must alternate, starting with a rising edge */
+        }
+        if (i > 0 && got[i] < got[i - 1]) {
+            ok = 0;  /* must never go back in time */
+        }
+    }
+    if (count != sc->expect_count) {
+        ok = 0;
+    } else {
+        for (int i = 0; i < count; i++) {
+            /* Fill-ins only have block resolution */
+            uint32_t diff = got[i] > sc->expect[i] ? got[i] - sc->expect[i] : sc->expect[i] - got[i];
+            if (diff > BLOCK_US) {
+                ok = 0;
+            }
+        }
+    }
+    printf("  %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        failed += !run(&scenarios[i]);
+    }
+    return failed != 0;
+}
@@ -0,0 +1,120 @@
+/* Build: gcc -O2 -std=c11 -I../Common/Inc mfsk_check.c ../Common/Src/mfsk.c ../Common/Src/goertzel.c -lm -o mfsk_check
+ * Usage: ./mfsk_check ["text"]
+ *
+ * Host round trip for the MFSK link (mfsk.c): the encoder's symbols are
+ * rendered as square-wave buzzer tones with noise, sampled at MCU2's rate,
+ * cut into 128-sample blocks, classified by a Goertzel bank the way MCU2's
+ * Process_Mfsk does, and fed to the decoder. The burst is started at seven
+ * phase offsets against the block grid; every offset must return the text.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "mfsk.h"
+#include "goertzel.h"
+
+/* Same values as MCU2 (sampler.h, channel.h) */
+#define RATE_HZ 16000
+#define BLOCK_LEN 128
+#define TONE_POWER_ON (100.0f * 100.0f)
+
+#define SYMBOL_SAMPLES (MFSK_SYMBOL_US * RATE_HZ / 1000000U)
+#define AMPLITUDE 600       /* square wave swing around mid-scale, ADC counts */
+#define NOISE 300           /* peak uniform noise, ADC counts */
+#define OFFSETS 7
+#define MAX_TEXT 128
+
+typedef struct {
+    const char *text;
+    size_t pos;
+} TextSource;
+
+static char next_char(void *ctx)
+{
+    TextSource *s = ctx;
+    return s->text[s->pos] != '\0' ? s->text[s->pos++] : '\0';
+}
+
+static uint32_t noise_state = 1;
+
+/* Uniform noise in [-NOISE, NOISE] from a small LCG, repeatable across runs */
+static int noise(void)
+{
+    noise_state = noise_state * 1103515245U + 12345U;
+    return (int)((noise_state >> 16) % (2 * NOISE + 1)) - NOISE;
+}
+
+/* Run one burst starting offset samples into the first block; returns 1 if the text came back */
+static int round_trip(const char *text, uint32_t offset, const Goertzel *bins)
+{
+    MfskEncoder enc;
+    MfskDecoder dec;
+    TextSource src = {text, 0};
+    uint16_t block[BLOCK_LEN];
+    char out[MAX_TEXT];
+    size_t out_len = 0;
+    uint32_t fill = 0;
+    uint32_t t = 0;           /* sample index, for the tone phase */
+    uint32_t remaining = offset;
+    int8_t tone = -2;         /* -2: leading silence, -1: trailing silence */
+    uint32_t tail = 4 * BLOCK_LEN;
+
+    Mfsk_EncoderInit(&enc);
+    Mfsk_DecoderInit(&dec);
+    for (;;) {
+        if (remaining == 0) {
+            if (tone == -1) {
+                break;
+            }
+            tone = Mfsk_Next(&enc, next_char, &src);
+            remaining = tone >= 0 ? SYMBOL_SAMPLES : tail;
+        }
+        int x = 2048 + noise();
+        if (tone >= 0) {
+            /* The buzzer is driven by PWM: a square wave, odd harmonics included */
+            double phase = fmod((double)t * MFSK_TONE_HZ(tone) / RATE_HZ, 1.0);
+            x += phase < 0.5 ? AMPLITUDE : -AMPLITUDE;
+        }
+        block[fill++] = (uint16_t)(x < 0 ? 0 : (x > 4095 ? 4095 : x));
+        t++;
+        remaining--;
+
+        if (fill == BLOCK_LEN) {
+            float best_power = TONE_POWER_ON;
+            int8_t best = -1;
+            for (uint8_t i = 0; i < MFSK_TONES; i++) {
+                float power = Goertzel_Power(&bins[i], block);
+                if (power >= best_power) {
+                    best_power = power;
+                    best = (int8_t)i;
+                }
+            }
+            char c = Mfsk_Block(&dec, best);
+            if (c != '\0' && out_len < MAX_TEXT - 1) {
+                out[out_len++] = c;
+            }
+            fill = 0;
+        }
+    }
+    out[out_len] = '\0';
+
+    int ok = strcmp(out, text) == 0;
+    printf("offset %3lu samples: \"%s\" %s\n", (unsigned long)offset, out, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *text = argc > 1 ? argv[1] : "HELLO CYU 0123 mfsk!";
+    Goertzel bins[MFSK_TONES];
+    int failed = 0;
+
+    for (uint8_t i = 0; i < MFSK_TONES; i++) {
+        Goertzel_Init(&bins[i], MFSK_TONE_HZ(i), RATE_HZ, BLOCK_LEN);
+    }
+    for (uint32_t k = 0; k < OFFSETS; k++) {
+        failed += !round_trip(text, k * BLOCK_LEN / OFFSETS, bins);
+    }
+    return failed != 0;
+}
@@ -1,7 +1,26 @@
+/* Build: gcc -std=c11 -I../Common/Inc sender.c ../Common/Src/morse.c ../Common/Src/morse_timing.c ../Common/Src/morse_timeline.c -o sender */
+/* nanosleep is POSIX, not ISO C: request it explicitly so -std=c11 still declares it */
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include "morse_timeline.h"
+
+#define MAX_RUNS 1024
+
+/* Sleep for a run length in microseconds; unlike usleep this also takes runs of a second or more */
+static void sleep_us(uint32_t us)
+{
+    struct timespec ts = {us / 1000000U, (long)(us % 1000000U) * 1000L};
+
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+        /* interrupted by a signal: sleep the remainder */
+    }
+}
 
 /* Function to convert a character to Morse code */
 char * string_to_morse(char c)
@@ -32,9 +51,20 @@ char * string_to_morse(char c)
     return "?";
 }
 
-int main()
+int main(int argc, char *argv[])
 {
     char text[] = "Hello World 123";
+    static uint32_t runs[MAX_RUNS];
+
+    /* Same PARIS/Farnsworth model as both firmwares: ./sender [wpm [char_wpm]] */
+    int wpm = argc > 1 ? atoi(argv[1]) : MORSE_WPM;
+    int char_wpm = argc > 2 ? atoi(argv[2]) : (argc > 1 ? wpm : MORSE_CHAR_WPM);
+    if (wpm <= 0 || wpm > 255 || char_wpm <= 0 || char_wpm > 255) {
+        fprintf(stderr, "wpm must be between 1 and 255\n");
+        return 1;
+    }
+    MorseTiming timing;
+    MorseTiming_Init(&timing, (uint8_t)wpm, (uint8_t)char_wpm);
 
     /* FOR DEBUG USAGE */
     printf("Original : %s\n", text);
@@ -42,29 +72,21 @@ int main()
 
     /* Convert and print each character in the text to Morse code */
     for (int i = 0; i < strlen(text); i++) {
-        char * morse_code = string_to_morse(text[i]);
-        for(int j = 0; j < strlen(morse_code); j++){
-            /* FOR DEBUG USAGE */
-            printf("%c", morse_code[j]);
-            if(morse_code[j] == '.'){
-                /* send a short sound */
-                sleep(1);
-                /* mico controler code here */
-            } else if(morse_code[j] == '-'){
-                /* send a long sound */
-                sleep(1);
-                /* mico controler code here */
-            } else if(morse_code[j] == ' '){
-                /* sleep for 3 second */
-                sleep(3);
-            } else if(morse_code[j] == '/'){
-                /* sleep for 5 second */
-                sleep(5);
-            } 
+        printf("%s ", string_to_morse(text[i]));
+    }
+    printf("\n");
+    fflush(stdout);
+
+    /* Play the key-down / key-up timeline: even runs are marks, odd runs are gaps */
+    uint16_t count = Morse_Timeline(text, &timing, runs, MAX_RUNS);
+    for (uint16_t i = 0; i < count; i++) {
+        if ((i & 1U) == 0) {
+            /* key down: mico controler code here */
+        } else {
+            /* key up: mico controler code here */
         }
-        /* FOR DEBUG USAGE */
-        printf(" ");
+        sleep_us(runs[i]);
     }
 
     return 0;
-}
\ No newline at end of file
+}